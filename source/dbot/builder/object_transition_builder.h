@@ -31,6 +31,7 @@
 
 #include <Eigen/Dense>
 #include <dbot/builder/transition_function_builder.h>
+#include <dbot/model/block_diagonal_linear_transition.h>
 #include <fl/model/transition/linear_transition.hpp>
 #include <fl/util/meta.hpp>
 #include <fl/util/profiling.hpp>
@@ -67,6 +68,11 @@ public:
                                  typename ObjectStateTrait<State>::Noise,
                                  typename ObjectStateTrait<State>::Input>
         DerivedModel;
+    typedef BlockDiagonalLinearTransition<
+        State,
+        typename ObjectStateTrait<State>::Noise,
+        typename ObjectStateTrait<State>::Input>
+        BatchModel;
 
     struct Parameters
     {
@@ -81,10 +87,14 @@ public:
     };
 
     ObjectTransitionBuilder(const Parameters& param) : param_(param) {}
+    /**
+     * \brief Builds the transition of build_model() with support for
+     *        propagating batches of states part by part
+     */
     virtual std::shared_ptr<Model> build() const
     {
-        auto model =
-            std::shared_ptr<DerivedModel>(new DerivedModel(build_model()));
+        auto model = std::make_shared<BatchModel>(build_model(),
+                                                  param_.part_count);
 
         return std::static_pointer_cast<Model>(model);
     }
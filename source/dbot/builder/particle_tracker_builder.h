@@ -123,6 +123,10 @@ public:
 
         auto filter = std::shared_ptr<Filter>(
             new Filter(transition, sensor, sampling_blocks, max_kl_divergence));
+
+        // propagate the particles on the executor of the sensor
+        if (sensor->executor()) filter->executor(sensor->executor());
+
         return filter;
     }
 
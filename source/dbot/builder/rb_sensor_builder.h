@@ -84,6 +84,13 @@ public:
         Kinect kinect;
         double delta_time;
         int sample_count;
+        // 1 renders serially, 0 selects the number of hardware threads
+        int thread_count = 1;
+        // number of levels of detail of the CPU renderer including the
+        // loaded mesh, each keeping level_reduction of the triangles of the
+        // previous one. A single level uses the levels of the object model.
+        int level_count = 1;
+        double level_reduction = 0.5;
         bool use_custom_shaders;
         std::string vertex_shader_file;
         std::string fragment_shader_file;
@@ -31,6 +31,7 @@
 
 #include <dbot/builder/rb_sensor_builder.h>
 #include <dbot/model/kinect_image_model.h>
+#include <dbot/thread_pool.h>
 
 #ifdef DBOT_BUILD_GPU
 #include <dbot/gpu/kinect_image_model_gpu.h>
@@ -159,6 +160,39 @@ auto RbSensorBuilder<State>::create_renderer() const
     std::shared_ptr<RigidBodyRenderer> renderer(new RigidBodyRenderer(
         object_model_->vertices(), object_model_->triangle_indices()));
 
+    // the levels are generated for this renderer only, the object model may
+    // be shared by builders with other settings
+    if (params_.level_count > 1)
+    {
+        std::vector<ObjectModel::Vertices> level_vertices;
+        std::vector<ObjectModel::TriangleIndecies> level_indices;
+        object_model_->generate_levels(params_.level_count,
+                                       params_.level_reduction,
+                                       level_vertices,
+                                       level_indices);
+
+        for (size_t level = 0; level < level_vertices.size(); ++level)
+        {
+            renderer->add_level_of_detail(level_vertices[level],
+                                          level_indices[level]);
+        }
+    }
+    else
+    {
+        for (int level = 1; level < object_model_->count_levels(); ++level)
+        {
+            renderer->add_level_of_detail(
+                object_model_->vertices(level),
+                object_model_->triangle_indices(level));
+        }
+    }
+
+    if (params_.thread_count != 1)
+    {
+        renderer->executor(
+            std::make_shared<ThreadPool>(params_.thread_count));
+    }
+
     return renderer;
 }
 }
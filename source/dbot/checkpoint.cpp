@@ -0,0 +1,238 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file checkpoint.cpp
+ * \date October 2016
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <dbot/checkpoint.h>
+
+namespace dbot
+{
+namespace
+{
+const char magic[8] = {'D', 'B', 'O', 'T', 'C', 'K', 'P', 'T'};
+const uint32_t version = 1;
+const size_t alignment = 64;
+const size_t max_name_length = 47;
+
+/**
+ * \internal
+ * Layout of the file header and of the entries of the table following it
+ */
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_count;
+};
+
+struct FileEntry
+{
+    char name[max_name_length + 1];
+    char type;
+    char padding[7];
+    uint64_t count;
+    uint64_t offset;
+};
+
+static_assert(sizeof(FileEntry) == 72, "unexpected checkpoint entry layout");
+
+size_t aligned(size_t offset)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * \internal
+ * Compares the name of a table entry. Names which are not terminated within
+ * the entry are corrupt and match nothing.
+ */
+bool has_name(const FileEntry& entry, const std::string& name)
+{
+    const size_t length = strnlen(entry.name, sizeof(entry.name));
+    return length < sizeof(entry.name) && length == name.size() &&
+           std::memcmp(entry.name, name.data(), length) == 0;
+}
+}
+
+void CheckpointWriter::add(const std::string& name,
+                           char type,
+                           size_t element_size,
+                           const char* data,
+                           size_t count)
+{
+    if (name.size() > max_name_length)
+    {
+        throw CheckpointException("checkpoint entry name " + name +
+                                  " is too long");
+    }
+
+    Entry entry;
+    entry.name = name;
+    entry.type = type;
+    entry.count = count;
+    entry.bytes.assign(data, data + element_size * count);
+    entries_.push_back(std::move(entry));
+}
+
+void CheckpointWriter::write(const std::string& path) const
+{
+    FileHeader header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.entry_count = entries_.size();
+
+    std::vector<FileEntry> table(entries_.size());
+    size_t offset =
+        aligned(sizeof(FileHeader) + table.size() * sizeof(FileEntry));
+    for (size_t i = 0; i < entries_.size(); i++)
+    {
+        std::memset(&table[i], 0, sizeof(FileEntry));
+        std::strncpy(table[i].name, entries_[i].name.c_str(), max_name_length);
+        table[i].type = entries_[i].type;
+        table[i].count = entries_[i].count;
+        table[i].offset = offset;
+        offset = aligned(offset + entries_[i].bytes.size());
+    }
+
+    // the file is written next to the target and renamed into place, such
+    // that an interrupted write leaves the previous checkpoint intact
+    const std::string temporary_path = path + ".tmp";
+    std::ofstream file(temporary_path, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+    {
+        throw CheckpointException("cannot open checkpoint " + temporary_path);
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(table.data()),
+               table.size() * sizeof(FileEntry));
+
+    const std::vector<char> padding(alignment, 0);
+    size_t position = sizeof(FileHeader) + table.size() * sizeof(FileEntry);
+    for (size_t i = 0; i < entries_.size(); i++)
+    {
+        file.write(padding.data(), table[i].offset - position);
+        file.write(entries_[i].bytes.data(), entries_[i].bytes.size());
+        position = table[i].offset + entries_[i].bytes.size();
+    }
+
+    file.close();
+    if (file.fail() || std::rename(temporary_path.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporary_path.c_str());
+        throw CheckpointException("cannot write checkpoint " + path);
+    }
+}
+
+CheckpointReader::CheckpointReader(const std::string& path)
+    : path_(path), map_(nullptr), size_(0)
+{
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+    {
+        throw CheckpointException("cannot open checkpoint " + path);
+    }
+
+    struct stat status;
+    if (fstat(descriptor, &status) == 0 && status.st_size > 0)
+    {
+        void* map = mmap(
+            nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (map != MAP_FAILED)
+        {
+            map_ = static_cast<const char*>(map);
+            size_ = status.st_size;
+        }
+    }
+    close(descriptor);
+
+    const FileHeader* header = reinterpret_cast<const FileHeader*>(map_);
+    if (!map_ || size_ < sizeof(FileHeader) ||
+        std::memcmp(header->magic, magic, sizeof(magic)) != 0 ||
+        header->version != version ||
+        header->entry_count >
+            (size_ - sizeof(FileHeader)) / sizeof(FileEntry))
+    {
+        if (map_) munmap(const_cast<char*>(map_), size_);
+        throw CheckpointException(path + " is not a checkpoint");
+    }
+}
+
+CheckpointReader::~CheckpointReader()
+{
+    munmap(const_cast<char*>(map_), size_);
+}
+
+bool CheckpointReader::contains(const std::string& name) const
+{
+    const FileHeader* header = reinterpret_cast<const FileHeader*>(map_);
+    const FileEntry* table =
+        reinterpret_cast<const FileEntry*>(map_ + sizeof(FileHeader));
+
+    for (uint32_t i = 0; i < header->entry_count; i++)
+    {
+        if (has_name(table[i], name)) return true;
+    }
+    return false;
+}
+
+const char* CheckpointReader::find(const std::string& name,
+                                   char type,
+                                   size_t element_size,
+                                   size_t& count) const
+{
+    const FileHeader* header = reinterpret_cast<const FileHeader*>(map_);
+    const FileEntry* table =
+        reinterpret_cast<const FileEntry*>(map_ + sizeof(FileHeader));
+
+    for (uint32_t i = 0; i < header->entry_count; i++)
+    {
+        if (!has_name(table[i], name)) continue;
+
+        if (table[i].type != type)
+        {
+            throw CheckpointException("checkpoint entry " + name +
+                                      " has type " + table[i].type +
+                                      " instead of " + type);
+        }
+        if (table[i].offset % alignment != 0)
+        {
+            throw CheckpointException("checkpoint entry " + name +
+                                      " is not aligned");
+        }
+        if (table[i].count > 0 &&
+            (table[i].offset > size_ ||
+             table[i].count > (size_ - table[i].offset) / element_size))
+        {
+            throw CheckpointException(path_ + " is truncated");
+        }
+
+        count = table[i].count;
+        return map_ + table[i].offset;
+    }
+
+    throw CheckpointException("checkpoint " + path_ + " has no entry " + name);
+}
+}
@@ -0,0 +1,198 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file checkpoint.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief Represents an exception thrown if a checkpoint cannot be written,
+ *        read or does not contain the requested entry
+ */
+class CheckpointException : public std::exception
+{
+public:
+    explicit CheckpointException(const std::string& message)
+        : message_(message)
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+/** \cond internal */
+namespace internal
+{
+template <typename T>
+struct CheckpointType;
+
+#define DBOT_CHECKPOINT_TYPE(T, CODE)          \
+    template <>                                \
+    struct CheckpointType<T>                   \
+    {                                          \
+        static constexpr char code = CODE;     \
+    };
+
+DBOT_CHECKPOINT_TYPE(uint8_t, 'B')
+DBOT_CHECKPOINT_TYPE(uint16_t, 'H')
+DBOT_CHECKPOINT_TYPE(int32_t, 'i')
+DBOT_CHECKPOINT_TYPE(uint64_t, 'Q')
+DBOT_CHECKPOINT_TYPE(float, 'f')
+DBOT_CHECKPOINT_TYPE(double, 'd')
+
+#undef DBOT_CHECKPOINT_TYPE
+}
+/** \endcond */
+
+/**
+ * \brief Collects named arrays and writes them into a single binary file
+ *
+ * The file consists of a header, a table of entries and the raw data of each
+ * entry aligned to 64 bytes in the native byte order. Hence the file can be
+ * mapped into memory and the arrays used in place by a CheckpointReader.
+ */
+class CheckpointWriter
+{
+public:
+    template <typename T>
+    void add(const std::string& name, const T* data, size_t count)
+    {
+        add(name,
+            internal::CheckpointType<T>::code,
+            sizeof(T),
+            reinterpret_cast<const char*>(data),
+            count);
+    }
+
+    template <typename T>
+    void add(const std::string& name, const std::vector<T>& values)
+    {
+        add(name, values.data(), values.size());
+    }
+
+    /**
+     * \brief Writes all entries to \a path, replacing an existing file. The
+     *        data is written to path.tmp first and renamed into place, hence
+     *        an existing checkpoint stays intact if writing fails.
+     *
+     * \throws CheckpointException if the file cannot be written
+     */
+    void write(const std::string& path) const;
+
+private:
+    struct Entry
+    {
+        std::string name;
+        char type;
+        size_t count;
+        std::vector<char> bytes;
+    };
+
+    void add(const std::string& name,
+             char type,
+             size_t element_size,
+             const char* data,
+             size_t count);
+
+private:
+    std::vector<Entry> entries_;
+};
+
+/**
+ * \brief Maps a checkpoint file into memory and provides its arrays without
+ *        copying them
+ */
+class CheckpointReader
+{
+public:
+    /**
+     * \throws CheckpointException if the file cannot be mapped or is not a
+     *         checkpoint
+     */
+    explicit CheckpointReader(const std::string& path);
+    ~CheckpointReader();
+
+    CheckpointReader(const CheckpointReader&) = delete;
+    CheckpointReader& operator=(const CheckpointReader&) = delete;
+
+    bool contains(const std::string& name) const;
+
+    /**
+     * \brief Pointer to the data of the entry \a name within the mapped file.
+     *        It is valid for the lifetime of the reader.
+     *
+     * \throws CheckpointException if there is no such entry or it has a
+     *         different type
+     */
+    template <typename T>
+    const T* data(const std::string& name, size_t& count) const
+    {
+        return reinterpret_cast<const T*>(
+            find(name, internal::CheckpointType<T>::code, sizeof(T), count));
+    }
+
+    /**
+     * \brief Copy of the entry \a name
+     */
+    template <typename T>
+    std::vector<T> vector(const std::string& name) const
+    {
+        size_t count;
+        const T* values = data<T>(name, count);
+        return std::vector<T>(values, values + count);
+    }
+
+    /**
+     * \brief Copy of the entry \a name which must have exactly \a count
+     *        elements
+     */
+    template <typename T>
+    std::vector<T> vector(const std::string& name, size_t count) const
+    {
+        std::vector<T> values = vector<T>(name);
+        if (values.size() != count)
+        {
+            throw CheckpointException(
+                "checkpoint entry " + name + " has " +
+                std::to_string(values.size()) + " elements instead of " +
+                std::to_string(count));
+        }
+        return values;
+    }
+
+private:
+    const char* find(const std::string& name,
+                     char type,
+                     size_t element_size,
+                     size_t& count) const;
+
+private:
+    std::string path_;
+    const char* map_;
+    size_t size_;
+};
+}
@@ -0,0 +1,161 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file checkpoint_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <dbot/checkpoint.h>
+
+class CheckpointTests : public ::testing::Test
+{
+protected:
+    CheckpointTests() : path_("dbot_checkpoint_test.bin") {}
+    ~CheckpointTests() { std::remove(path_.c_str()); }
+
+    std::string path_;
+};
+
+TEST_F(CheckpointTests, entries_round_trip)
+{
+    std::vector<double> values = {1.5, -2.25, 3e100};
+    std::vector<int32_t> indices = {7, 0, -3, 1 << 30};
+    std::vector<uint8_t> bytes(1000, 42);
+    uint64_t counter = uint64_t(1) << 40;
+
+    dbot::CheckpointWriter writer;
+    writer.add("values", values);
+    writer.add("indices", indices);
+    writer.add("empty", std::vector<float>());
+    writer.add("bytes", bytes);
+    writer.add("counter", &counter, 1);
+    writer.write(path_);
+
+    dbot::CheckpointReader reader(path_);
+    EXPECT_EQ(reader.vector<double>("values"), values);
+    EXPECT_EQ(reader.vector<int32_t>("indices", 4), indices);
+    EXPECT_TRUE(reader.vector<float>("empty").empty());
+    EXPECT_EQ(reader.vector<uint8_t>("bytes"), bytes);
+    EXPECT_EQ(reader.vector<uint64_t>("counter", 1)[0], counter);
+    EXPECT_TRUE(reader.contains("values"));
+    EXPECT_FALSE(reader.contains("missing"));
+}
+
+TEST_F(CheckpointTests, data_is_aligned_in_place)
+{
+    std::vector<float> values(100, 0.5f);
+
+    dbot::CheckpointWriter writer;
+    writer.add("a", std::vector<uint8_t>(3, 1));
+    writer.add("b", values);
+    writer.write(path_);
+
+    dbot::CheckpointReader reader(path_);
+    size_t count;
+    const float* data = reader.data<float>("b", count);
+    EXPECT_EQ(count, values.size());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(data) % 64, 0u);
+    EXPECT_EQ(data[99], 0.5f);
+}
+
+TEST_F(CheckpointTests, mismatches_throw)
+{
+    dbot::CheckpointWriter writer;
+    writer.add("values", std::vector<double>(3, 1.));
+    writer.write(path_);
+
+    dbot::CheckpointReader reader(path_);
+    EXPECT_THROW(reader.vector<float>("values"), dbot::CheckpointException);
+    EXPECT_THROW(reader.vector<double>("values", 4),
+                 dbot::CheckpointException);
+    EXPECT_THROW(reader.vector<double>("missing"), dbot::CheckpointException);
+
+    EXPECT_THROW(writer.add(std::string(64, 'x'), std::vector<double>()),
+                 dbot::CheckpointException);
+}
+
+TEST_F(CheckpointTests, invalid_files_throw)
+{
+    EXPECT_THROW(dbot::CheckpointReader("dbot_missing_checkpoint.bin"),
+                 dbot::CheckpointException);
+
+    std::ofstream(path_) << "not a checkpoint";
+    EXPECT_THROW(dbot::CheckpointReader reader(path_),
+                 dbot::CheckpointException);
+}
+
+TEST_F(CheckpointTests, corrupt_tables_throw)
+{
+    // the table follows the 16 byte header, the name takes the first 48
+    // bytes of an entry, the count and the offset bytes 56 and 64
+    auto corrupt = [&](size_t position, const void* bytes, size_t size)
+    {
+        dbot::CheckpointWriter writer;
+        writer.add("values", std::vector<double>(3, 1.));
+        writer.write(path_);
+
+        std::fstream file(path_,
+                          std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(position);
+        file.write(static_cast<const char*>(bytes), size);
+    };
+
+    const std::string name(48, 'x');
+    corrupt(16, name.data(), name.size());
+    {
+        dbot::CheckpointReader reader(path_);
+        EXPECT_FALSE(reader.contains(name));
+        EXPECT_THROW(reader.vector<double>("values"),
+                     dbot::CheckpointException);
+    }
+
+    // the size of the entry overflows
+    const uint64_t count = (uint64_t(1) << 61) + 1;
+    corrupt(16 + 56, &count, sizeof(count));
+    EXPECT_THROW(dbot::CheckpointReader(path_).vector<double>("values"),
+                 dbot::CheckpointException);
+
+    const uint64_t offset = 64 + 8;
+    corrupt(16 + 64, &offset, sizeof(offset));
+    EXPECT_THROW(dbot::CheckpointReader(path_).vector<double>("values"),
+                 dbot::CheckpointException);
+}
+
+TEST_F(CheckpointTests, failed_write_keeps_previous_checkpoint)
+{
+    dbot::CheckpointWriter writer;
+    writer.add("values", std::vector<double>(3, 1.));
+    writer.write(path_);
+    EXPECT_FALSE(std::ifstream(path_ + ".tmp").good());
+
+    // the temporary file cannot be created where a directory is in the way
+    const std::string temporary_path = path_ + ".tmp";
+    ASSERT_EQ(mkdir(temporary_path.c_str(), 0700), 0);
+
+    dbot::CheckpointWriter other_writer;
+    other_writer.add("values", std::vector<double>(5, 2.));
+    EXPECT_THROW(other_writer.write(path_), dbot::CheckpointException);
+    rmdir(temporary_path.c_str());
+
+    dbot::CheckpointReader reader(path_);
+    EXPECT_EQ(reader.vector<double>("values"), std::vector<double>(3, 1.));
+}
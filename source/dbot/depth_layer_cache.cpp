@@ -0,0 +1,240 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_layer_cache.cpp
+ * \date October 2016
+ */
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include <dbot/depth_layer_cache.h>
+
+namespace dbot
+{
+DepthLayerCache::PoseKey::PoseKey(const Affine& pose)
+{
+    Eigen::Map<Eigen::Matrix<double, 3, 4>> map(data);
+    map = pose.matrix().topRows<3>();
+}
+
+bool DepthLayerCache::PoseKey::operator==(const PoseKey& other) const
+{
+    return std::equal(data, data + 12, other.data);
+}
+
+size_t DepthLayerCache::PoseKeyHash::operator()(const PoseKey& key) const
+{
+    std::hash<double> hash;
+    size_t seed = 0;
+    for (int i = 0; i < 12; ++i)
+    {
+        seed ^= hash(key.data[i]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+DepthLayerCache::DepthLayerCache(
+    const std::shared_ptr<RigidBodyRenderer>& renderer)
+    : renderer_(renderer),
+      n_rows_(0),
+      n_cols_(0),
+      renderer_revision_(renderer->revision()),
+      rendered_layer_count_(0)
+{
+    camera_matrix_.setZero();
+}
+
+void DepthLayerCache::render(const std::vector<std::vector<Affine>>& poses,
+                             const Matrix& camera_matrix,
+                             int n_rows,
+                             int n_cols)
+{
+    if (camera_matrix != camera_matrix_ || n_rows != n_rows_ ||
+        n_cols != n_cols_ || renderer_->revision() != renderer_revision_)
+    {
+        clear();
+        camera_matrix_ = camera_matrix;
+        n_rows_ = n_rows;
+        n_cols_ = n_cols;
+        renderer_revision_ = renderer_->revision();
+    }
+
+    // assign a layer to each part of each particle ---------------------------
+    const size_t part_count = poses.empty() ? 0 : poses[0].size();
+    layer_maps_.resize(part_count);
+    next_layer_maps_.resize(part_count);
+    particle_layers_.resize(poses.size());
+    jobs_.clear();
+
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+        particle_layers_[i].resize(part_count);
+        for (size_t k = 0; k < part_count; ++k)
+        {
+            PoseKey key(poses[i][k]);
+
+            auto next = next_layer_maps_[k].find(key);
+            if (next != next_layer_maps_[k].end())
+            {
+                particle_layers_[i][k] = next->second;
+                continue;
+            }
+
+            int layer;
+            auto previous = layer_maps_[k].find(key);
+            if (previous != layer_maps_[k].end())
+            {
+                layer = previous->second;
+                layer_maps_[k].erase(previous);
+            }
+            else
+            {
+                layer = acquire_layer();
+                jobs_.push_back({k, &poses[i][k], layer});
+            }
+
+            next_layer_maps_[k].emplace(key, layer);
+            particle_layers_[i][k] = layer;
+        }
+    }
+
+    // release the layers which are not used anymore
+    for (size_t k = 0; k < part_count; ++k)
+    {
+        for (const auto& entry : layer_maps_[k])
+        {
+            free_layers_.push_back(entry.second);
+        }
+        layer_maps_[k].clear();
+    }
+    layer_maps_.swap(next_layer_maps_);
+
+    // render the missing layers ----------------------------------------------
+    rendered_layer_count_ = jobs_.size();
+    parallel_for(jobs_.size(), [&](int chunk, size_t begin, size_t end)
+                 {
+                     for (size_t j = begin; j < end; ++j)
+                     {
+                         DepthLayer& layer = layers_[jobs_[j].layer];
+                         renderer_->RenderPart(jobs_[j].part,
+                                               *jobs_[j].pose,
+                                               camera_matrix,
+                                               n_rows,
+                                               n_cols,
+                                               contexts_[chunk],
+                                               layer.indices,
+                                               layer.depth);
+                     }
+                 });
+
+    // compose the layers of each particle ------------------------------------
+    composites_.resize(poses.size());
+    parallel_for(poses.size(), [&](int chunk, size_t begin, size_t end)
+                 {
+                     for (size_t i = begin; i < end; ++i)
+                     {
+                         composite(i, composite_scratch_[chunk]);
+                     }
+                 });
+}
+
+auto DepthLayerCache::depth(size_t particle) const -> const DepthLayer &
+{
+    return composites_[particle];
+}
+
+int DepthLayerCache::rendered_layer_count() const
+{
+    return rendered_layer_count_;
+}
+
+void DepthLayerCache::clear()
+{
+    layers_.clear();
+    free_layers_.clear();
+    layer_maps_.clear();
+    next_layer_maps_.clear();
+    particle_layers_.clear();
+    composites_.clear();
+}
+
+int DepthLayerCache::acquire_layer()
+{
+    if (free_layers_.empty())
+    {
+        layers_.push_back(DepthLayer());
+        return layers_.size() - 1;
+    }
+
+    int layer = free_layers_.back();
+    free_layers_.pop_back();
+    return layer;
+}
+
+void DepthLayerCache::composite(size_t particle, std::vector<float>& scratch)
+{
+    const std::vector<int>& part_layers = particle_layers_[particle];
+    DepthLayer& result = composites_[particle];
+
+    if (part_layers.size() == 1)
+    {
+        result = layers_[part_layers[0]];
+        return;
+    }
+
+    // min-composite in a dense buffer which is reset afterwards
+    const float infinity = std::numeric_limits<float>::infinity();
+    scratch.resize(n_rows_ * n_cols_, infinity);
+
+    result.indices.clear();
+    for (int id : part_layers)
+    {
+        const DepthLayer& layer = layers_[id];
+        for (size_t i = 0; i < layer.indices.size(); ++i)
+        {
+            float& value = scratch[layer.indices[i]];
+            if (value == infinity) result.indices.push_back(layer.indices[i]);
+            if (layer.depth[i] < value) value = layer.depth[i];
+        }
+    }
+    std::sort(result.indices.begin(), result.indices.end());
+
+    result.depth.resize(result.indices.size());
+    for (size_t i = 0; i < result.indices.size(); ++i)
+    {
+        result.depth[i] = scratch[result.indices[i]];
+        scratch[result.indices[i]] = infinity;
+    }
+}
+
+void DepthLayerCache::parallel_for(size_t count, const Executor::Task& task)
+{
+    const std::shared_ptr<Executor>& executor = renderer_->executor();
+
+    const int chunks = executor ? executor->thread_count() : 1;
+    contexts_.resize(chunks);
+    composite_scratch_.resize(chunks);
+
+    if (executor)
+    {
+        executor->parallel_for(count, task);
+    }
+    else
+    {
+        task(0, 0, count);
+    }
+}
+}
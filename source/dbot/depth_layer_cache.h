@@ -0,0 +1,140 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_layer_cache.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <dbot/rigid_body_renderer.h>
+
+namespace dbot
+{
+/**
+ * \brief Renders multi-part objects for many particles while keeping one
+ *        depth layer per part and pose.
+ *
+ * The coordinate particle filter only changes the poses of the parts within
+ * the current sampling block. Layers are looked up by the exact pose of the
+ * part, hence unchanged parts are not rendered again, even if the particles
+ * have been resampled in between. The depth of a particle is the minimum over
+ * the layers of its parts.
+ *
+ * Layers are kept as long as they are used by at least one particle of the
+ * most recent call to render(). All layers are dropped when the camera, the
+ * image size or the revision of the renderer change.
+ */
+class DepthLayerCache
+{
+public:
+    typedef RigidBodyRenderer::Affine Affine;
+    typedef RigidBodyRenderer::Matrix Matrix;
+
+    /**
+     * \brief Sparse depth image containing only the pixels hit by the object
+     */
+    struct DepthLayer
+    {
+        std::vector<int> indices;
+        std::vector<float> depth;
+    };
+
+public:
+    explicit DepthLayerCache(
+        const std::shared_ptr<RigidBodyRenderer>& renderer);
+
+    /**
+     * \brief Renders the depth of all particles where poses[i][k] is the pose
+     *        of part k of particle i
+     */
+    void render(const std::vector<std::vector<Affine>>& poses,
+                const Matrix& camera_matrix,
+                int n_rows,
+                int n_cols);
+
+    /**
+     * \brief Depth of the given particle computed in the last render() call
+     */
+    const DepthLayer& depth(size_t particle) const;
+
+    /**
+     * \brief Number of part layers actually rendered in the last render() call
+     */
+    int rendered_layer_count() const;
+
+    /**
+     * \brief Drops all cached layers
+     */
+    void clear();
+
+private:
+    /** \cond internal */
+    struct PoseKey
+    {
+        explicit PoseKey(const Affine& pose);
+        bool operator==(const PoseKey& other) const;
+
+        double data[12];
+    };
+
+    struct PoseKeyHash
+    {
+        size_t operator()(const PoseKey& key) const;
+    };
+
+    typedef std::unordered_map<PoseKey, int, PoseKeyHash> LayerMap;
+
+    struct RenderJob
+    {
+        size_t part;
+        const Affine* pose;
+        int layer;
+    };
+
+    int acquire_layer();
+    void composite(size_t particle, std::vector<float>& scratch);
+    void parallel_for(size_t count, const Executor::Task& task);
+    /** \endcond */
+
+private:
+    std::shared_ptr<RigidBodyRenderer> renderer_;
+
+    Matrix camera_matrix_;
+    int n_rows_;
+    int n_cols_;
+    size_t renderer_revision_;
+
+    // layer storage and lookup of the layers by part pose
+    std::vector<DepthLayer> layers_;
+    std::vector<int> free_layers_;
+    std::vector<LayerMap> layer_maps_;
+    std::vector<LayerMap> next_layer_maps_;
+
+    // per particle layer ids and composed depth
+    std::vector<std::vector<int>> particle_layers_;
+    std::vector<DepthLayer> composites_;
+
+    // work buffers, one per executor chunk. The composite buffers cover the
+    // full image and are kept filled with infinity.
+    std::vector<RenderJob> jobs_;
+    std::vector<RigidBodyRenderer::RenderContext> contexts_;
+    std::vector<std::vector<float>> composite_scratch_;
+    int rendered_layer_count_;
+};
+}
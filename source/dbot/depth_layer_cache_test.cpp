@@ -0,0 +1,174 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_layer_cache_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <dbot/depth_layer_cache.h>
+#include <dbot/thread_pool.h>
+
+namespace
+{
+typedef dbot::RigidBodyRenderer Renderer;
+typedef dbot::DepthLayerCache::Affine Affine;
+
+std::shared_ptr<Renderer> create_renderer(int parts)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices(parts);
+    std::vector<std::vector<std::vector<int>>> indices(parts);
+    for (int k = 0; k < parts; ++k)
+    {
+        double s = 0.05 + 0.02 * k;
+        for (int i = 0; i < 8; ++i)
+        {
+            vertices[k].push_back(Eigen::Vector3d(
+                i & 1 ? s : -s, i & 2 ? s : -s, i & 4 ? s : -s));
+        }
+        indices[k] = {{0, 2, 1},
+                      {1, 2, 3},
+                      {4, 5, 6},
+                      {5, 7, 6},
+                      {0, 1, 4},
+                      {1, 5, 4},
+                      {2, 6, 3},
+                      {3, 6, 7},
+                      {0, 4, 2},
+                      {2, 4, 6},
+                      {1, 3, 5},
+                      {3, 7, 5}};
+    }
+    return std::make_shared<Renderer>(vertices, indices);
+}
+
+Eigen::Matrix3d camera_matrix()
+{
+    Eigen::Matrix3d camera_matrix;
+    camera_matrix << 260., 0., 79.5, 0., 260., 59.5, 0., 0., 1.;
+    return camera_matrix;
+}
+
+Affine pose(double x, double y, double z, double angle)
+{
+    Affine pose;
+    pose.setIdentity();
+    pose.translate(Eigen::Vector3d(x, y, z));
+    pose.rotate(
+        Eigen::AngleAxisd(angle, Eigen::Vector3d(3, 1, 2).normalized()));
+    return pose;
+}
+
+void expect_equal_to_rendering(Renderer& renderer,
+                               const std::vector<Affine>& poses,
+                               const dbot::DepthLayerCache::DepthLayer& layer)
+{
+    std::vector<int> indices;
+    std::vector<float> depth;
+    renderer.set_poses(poses);
+    renderer.Render(camera_matrix(), 120, 160, indices, depth);
+
+    EXPECT_EQ(indices, layer.indices);
+    EXPECT_EQ(depth, layer.depth);
+}
+}
+
+TEST(DepthLayerCacheTests, composite_matches_rendering)
+{
+    auto renderer = create_renderer(3);
+    renderer->executor(std::make_shared<dbot::ThreadPool>(2));
+
+    std::vector<std::vector<Affine>> poses;
+    for (int i = 0; i < 8; ++i)
+    {
+        poses.push_back({pose(0.01 * i, 0.0, 0.6, 0.2 * i),
+                         pose(0.05, 0.01 * i, 0.65, 0.1),
+                         pose(-0.05, 0.0, 0.55 + 0.01 * i, 0.3 * i)});
+    }
+
+    dbot::DepthLayerCache cache(renderer);
+    cache.render(poses, camera_matrix(), 120, 160);
+
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+        expect_equal_to_rendering(*renderer, poses[i], cache.depth(i));
+    }
+}
+
+TEST(DepthLayerCacheTests, renders_changed_parts_only)
+{
+    auto renderer = create_renderer(3);
+
+    std::vector<std::vector<Affine>> poses;
+    for (int i = 0; i < 10; ++i)
+    {
+        poses.push_back({pose(0.0, 0.0, 0.6, 0.1),
+                         pose(0.05, 0.0, 0.6, 0.2),
+                         pose(-0.05, 0.0, 0.6, 0.3)});
+    }
+
+    dbot::DepthLayerCache cache(renderer);
+    cache.render(poses, camera_matrix(), 120, 160);
+    EXPECT_EQ(cache.rendered_layer_count(), 3);
+
+    // perturb part 1 of every particle and shuffle the particles
+    for (int i = 0; i < 10; ++i)
+    {
+        poses[i][1] = pose(0.05, 0.002 * (i + 1), 0.6, 0.2);
+    }
+    std::swap(poses[2], poses[7]);
+
+    cache.render(poses, camera_matrix(), 120, 160);
+    EXPECT_EQ(cache.rendered_layer_count(), 10);
+
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+        expect_equal_to_rendering(*renderer, poses[i], cache.depth(i));
+    }
+
+    // nothing changed
+    cache.render(poses, camera_matrix(), 120, 160);
+    EXPECT_EQ(cache.rendered_layer_count(), 0);
+}
+
+TEST(DepthLayerCacheTests, renderer_changes_drop_layers)
+{
+    auto renderer = create_renderer(2);
+
+    std::vector<std::vector<Affine>> poses(
+        4, {pose(0.0, 0.0, 0.6, 0.1), pose(0.05, 0.0, 0.6, 0.2)});
+
+    dbot::DepthLayerCache cache(renderer);
+    cache.render(poses, camera_matrix(), 120, 160);
+    EXPECT_EQ(cache.rendered_layer_count(), 2);
+
+    renderer->lod_pixels_per_triangle(8.);
+    cache.render(poses, camera_matrix(), 120, 160);
+    EXPECT_EQ(cache.rendered_layer_count(), 2);
+
+    renderer->rasterizer(Renderer::Rasterizer::Reference);
+    cache.render(poses, camera_matrix(), 120, 160);
+    EXPECT_EQ(cache.rendered_layer_count(), 2);
+
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+        expect_equal_to_rendering(*renderer, poses[i], cache.depth(i));
+    }
+
+    cache.render(poses, camera_matrix(), 120, 160);
+    EXPECT_EQ(cache.rendered_layer_count(), 0);
+}
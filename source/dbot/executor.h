@@ -0,0 +1,94 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file executor.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace dbot
+{
+/**
+ * \brief Represents the interface of a data parallel executor
+ *
+ * The range [0, count) is split into thread_count() contiguous chunks of
+ * (almost) equal size. The partitioning only depends on count and
+ * thread_count(), such that per chunk state, e.g. random number streams, gives
+ * reproducible results for a fixed number of threads.
+ */
+class Executor
+{
+public:
+    /**
+     * \brief Task applied to the chunk [begin, end) with the given index
+     */
+    typedef std::function<void(int chunk, size_t begin, size_t end)> Task;
+
+public:
+    virtual ~Executor() {}
+
+    /**
+     * \brief Runs the task on all chunks of [0, count) and blocks until all of
+     *        them are done
+     */
+    virtual void parallel_for(size_t count, const Task& task) = 0;
+
+    /**
+     * \brief Number of chunks the range is split into
+     */
+    virtual int thread_count() const = 0;
+
+    /**
+     * \brief Returns the range [begin, end) of the given chunk
+     */
+    static void chunk_range(size_t count,
+                            int chunks,
+                            int chunk,
+                            size_t& begin,
+                            size_t& end)
+    {
+        begin = count * chunk / chunks;
+        end = count * (chunk + 1) / chunks;
+    }
+};
+
+/**
+ * \brief Executes all chunks sequentially in the calling thread
+ */
+class SerialExecutor : public Executor
+{
+public:
+    explicit SerialExecutor(int chunks = 1) : chunks_(chunks) {}
+
+    void parallel_for(size_t count, const Task& task)
+    {
+        for (int chunk = 0; chunk < chunks_; ++chunk)
+        {
+            size_t begin, end;
+            chunk_range(count, chunks_, chunk, begin, end);
+            if (begin < end) task(chunk, begin, end);
+        }
+    }
+
+    int thread_count() const { return chunks_; }
+
+private:
+    int chunks_;
+};
+}
@@ -0,0 +1,74 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kld_sampling.cpp
+ * \date October 2016
+ */
+
+#include <cmath>
+#include <unordered_set>
+#include <vector>
+
+#include <dbot/filter/kld_sampling.h>
+
+namespace dbot
+{
+namespace
+{
+struct BinHash
+{
+    size_t operator()(const std::vector<long>& bin) const
+    {
+        size_t hash = bin.size();
+        for (long index : bin)
+        {
+            hash ^= std::hash<long>()(index) + 0x9e3779b9 + (hash << 6) +
+                    (hash >> 2);
+        }
+        return hash;
+    }
+};
+}
+
+size_t kld_sample_count(size_t occupied_bins, double epsilon, double z)
+{
+    if (occupied_bins < 2) return 1;
+
+    // Wilson-Hilferty approximation of the chi-square quantile
+    const double k = occupied_bins - 1;
+    const double a = 2. / (9. * k);
+    const double b = 1. - a + std::sqrt(a) * z;
+
+    return size_t(std::ceil(k / (2. * epsilon) * b * b * b));
+}
+
+size_t occupied_bins(const Eigen::MatrixXd& points,
+                     const Eigen::VectorXd& bin_sizes)
+{
+    std::unordered_set<std::vector<long>, BinHash> bins;
+    bins.reserve(points.cols());
+
+    std::vector<long> bin(points.rows());
+    for (int j = 0; j < points.cols(); ++j)
+    {
+        for (int i = 0; i < points.rows(); ++i)
+        {
+            bin[i] = long(std::floor(points(i, j) / bin_sizes[i]));
+        }
+        bins.insert(bin);
+    }
+
+    return bins.size();
+}
+}
@@ -0,0 +1,51 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kld_sampling.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <Eigen/Core>
+
+namespace dbot
+{
+/**
+ * \brief Number of samples of the KLD-sampling bound (Fox, Adapting the
+ *        Sample Size in Particle Filters Through KLD-Sampling, 2003)
+ *
+ * With this many samples the KL divergence between the sample based maximum
+ * likelihood estimate and the true posterior is below \a epsilon with
+ * probability 1 - delta, if the posterior occupies \a occupied_bins bins.
+ *
+ * \param [in] occupied_bins number of bins with support
+ * \param [in] epsilon       bound of the KL divergence
+ * \param [in] z             upper 1 - delta quantile of the standard normal
+ *                           distribution, e.g. 2.326 for delta = 0.01
+ */
+size_t kld_sample_count(size_t occupied_bins, double epsilon, double z);
+
+/**
+ * \brief Number of distinct bins of a regular grid occupied by the columns
+ *        of \a points
+ *
+ * \param [in] points    one point per column
+ * \param [in] bin_sizes edge length of the bins along each dimension
+ */
+size_t occupied_bins(const Eigen::MatrixXd& points,
+                     const Eigen::VectorXd& bin_sizes);
+}
@@ -0,0 +1,54 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kld_sampling_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/filter/kld_sampling.h>
+
+TEST(KldSamplingTests, sample_count_matches_chi_square_quantile)
+{
+    // (k - 1) / (2 epsilon) times the chi-square quantile over k - 1, here
+    // for 100 bins and delta = 0.01 where the exact quantile is 134.642
+    size_t count = dbot::kld_sample_count(100, 0.05, 2.326348);
+    EXPECT_NEAR(count, 134.642 / (2 * 0.05), 5);
+
+    EXPECT_EQ(dbot::kld_sample_count(0, 0.05, 2.33), 1u);
+    EXPECT_EQ(dbot::kld_sample_count(1, 0.05, 2.33), 1u);
+}
+
+TEST(KldSamplingTests, sample_count_grows_with_bins_and_precision)
+{
+    EXPECT_LT(dbot::kld_sample_count(10, 0.05, 2.33),
+              dbot::kld_sample_count(20, 0.05, 2.33));
+    EXPECT_LT(dbot::kld_sample_count(10, 0.05, 2.33),
+              dbot::kld_sample_count(10, 0.02, 2.33));
+    EXPECT_LT(dbot::kld_sample_count(10, 0.05, 1.64),
+              dbot::kld_sample_count(10, 0.05, 2.33));
+}
+
+TEST(KldSamplingTests, occupied_bins_of_points)
+{
+    Eigen::MatrixXd points(2, 6);
+    points << 0.1, 0.2, 0.9, 1.1, -0.1, 0.15,  //
+        0.0, 0.4, 0.3, 0.0, 0.0, 2.5;
+
+    EXPECT_EQ(dbot::occupied_bins(points, Eigen::Vector2d(1., 1.)), 4u);
+    EXPECT_EQ(dbot::occupied_bins(points, Eigen::Vector2d(10., 10.)), 2u);
+    EXPECT_EQ(dbot::occupied_bins(points.leftCols(3), Eigen::Vector2d(1., 1.)),
+              1u);
+}
@@ -25,18 +25,28 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
 #include <limits>
 #include <string>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <random>
+#include <sstream>
 
 #include <Eigen/Core>
 
 #include <fl/util/types.hpp>
-#include <fl/distribution/gaussian.hpp>
+#include <fl/util/random.hpp>
 #include <fl/distribution/discrete_distribution.hpp>
 #include <fl/util/profiling.hpp>
 
 #include <dbot/traits.h>
+#include <dbot/checkpoint.h>
+#include <dbot/executor.h>
+#include <dbot/filter/resampling.h>
+#include <dbot/gaussian_noise_generator.h>
+#include <dbot/model/batch_transition.h>
 #include <dbot/model/rao_blackwell_sensor.h>
 
 namespace dbot
@@ -52,11 +62,31 @@ public:
     typedef Eigen::Array<State, -1, 1> StateArray;
     typedef Eigen::Array<fl::Real, -1, 1> RealArray;
     typedef Eigen::Array<int, -1, 1> IntArray;
+    typedef Eigen::Matrix<fl::Real, -1, -1> Matrix;
 
     typedef typename Sensor::Observation Observation;
 
     typedef fl::DiscreteDistribution<State> Belief;
 
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * \brief Statistics of the sampling blocks skipped at a deadline
+     */
+    struct BlockStatistics
+    {
+        /// number of filter steps and of those which ran out of time
+        size_t frames;
+        size_t late_frames;
+        /// number of times each sampling block has been skipped
+        std::vector<size_t> skip_counts;
+        /// sampling blocks skipped in the last filter step
+        std::vector<int> last_skipped;
+        /// relative drop of the effective sample size caused by each
+        /// sampling block in the last filter step, negative if skipped
+        std::vector<double> ess_drops;
+    };
+
 public:
     /// constructor and destructor *********************************************
     RaoBlackwellCoordinateParticleFilter(
@@ -66,102 +96,260 @@ public:
         const fl::Real& max_kl_divergence = 0)
         : sensor_(sensor),
           transition_(transition),
-          max_kl_divergence_(max_kl_divergence)
+          max_kl_divergence_(max_kl_divergence),
+          resampling_scheme_(ResamplingScheme::Systematic),
+          executor_(std::make_shared<SerialExecutor>())
     {
-        sampling_blocks_ = sampling_blocks;
-
-        // make sure sizes are consistent --------------------------------------
-        size_t dimension = 0;
-        for (size_t i = 0; i < sampling_blocks_.size(); i++)
-        {
-            dimension += sampling_blocks_[i].size();
-        }
-        if (dimension != transition_->noise_dimension())
-        {
-            std::cout << "the dimension of the sampling blocks is " << dimension
-                      << " while the dimension of the noise is "
-                      << transition_->noise_dimension() << std::endl;
-            exit(-1);
-        }
+        batch_transition_ =
+            std::dynamic_pointer_cast<BatchTransition<Input>>(transition_);
+        block_seconds_ = 0;
+        this->sampling_blocks(sampling_blocks);
+        seed(RANDOM_SEED);
     }
     virtual ~RaoBlackwellCoordinateParticleFilter() noexcept {}
     /// the filter functions ***************************************************
     void filter(const Observation& observation, const Input& input)
+    {
+        filter(observation, input, Clock::time_point::max());
+    }
+
+    /**
+     * \brief Filter step which returns once the next sampling block would
+     *        not complete before \a deadline
+     *
+     * At least one block is processed. The noise of the skipped blocks stays
+     * zero in this step, i.e. their coordinates are only propagated by the
+     * deterministic part of the transition. Skipped blocks are processed
+     * first in the next step.
+     */
+    void filter(const Observation& observation,
+                const Input& input,
+                const Clock::time_point& deadline)
     {
         sensor_->set_observation(observation);
 
         loglikes_ = RealArray::Zero(belief_.size());
-        noises_ = std::vector<Noise>(
-            belief_.size(), Noise::Zero(transition_->noise_dimension()));
-        old_particles_ = belief_.locations();
-        for (size_t i_block = 0; i_block < sampling_blocks_.size(); i_block++)
+        start_propagation();
+        block_statistics_.ess_drops.assign(sampling_blocks_.size(), -1);
+
+        size_t executed = 0;
+        bool last_block = block_order_.empty();
+        while (!last_block)
         {
-            // add noise of this block -----------------------------------------
-            for (size_t i_sampl = 0; i_sampl < belief_.size(); i_sampl++)
+            const Clock::time_point block_begin = Clock::now();
+            const int i_block = block_order_[executed++];
+            const std::vector<int>& block = sampling_blocks_[i_block];
+
+            // the sensor updates its occlusions in the last block of the step
+            last_block = executed == block_order_.size() ||
+                         !next_block_fits(block_begin, deadline);
+
+            // noises of resampled particles are copied from their parents
+            // before they diverge
+            const bool copy_noises = noise_parents_.size() > 0;
+            if (copy_noises)
             {
-                for (size_t i = 0; i < sampling_blocks_[i_block].size(); i++)
-                {
-                    noises_[i_sampl](sampling_blocks_[i_block][i]) =
-                        unit_gaussian_.sample()(0);
-                }
+                next_noises_.resize(noises_.rows(), belief_.size());
             }
 
-            // propagate using partial noise -----------------------------------
-            for (size_t i_sampl = 0; i_sampl < belief_.size(); i_sampl++)
+            // add noise of this block and propagate using partial noise -------
+            const uint64_t noise_stream = noise_stream_++;
+            executor_->parallel_for(
+                belief_.size(),
+                [&](int chunk, size_t begin, size_t end)
+                {
+                    // variates of particle i are i * block size onwards in the
+                    // stream of this block, independent of the chunking
+                    std::vector<double> variates((end - begin) * block.size());
+                    noise_generator_.fill(noise_stream,
+                                          begin * block.size(),
+                                          variates.size(),
+                                          variates.data());
+
+                    Matrix& noises = copy_noises ? next_noises_ : noises_;
+                    const double* variate = variates.data();
+                    for (size_t i_sampl = begin; i_sampl < end; i_sampl++)
+                    {
+                        if (copy_noises)
+                        {
+                            noises.col(i_sampl) =
+                                noises_.col(noise_parents_[i_sampl]);
+                        }
+
+                        for (size_t i = 0; i < block.size(); i++)
+                        {
+                            noises(block[i], i_sampl) = *variate++;
+                        }
+
+                        if (!batch_transition_)
+                        {
+                            belief_.location(i_sampl) = transition_->state(
+                                State(old_states_.col(parents_[i_sampl])),
+                                Noise(noises.col(i_sampl)),
+                                input);
+                        }
+                    }
+
+                    if (batch_transition_)
+                    {
+                        propagate_batch(begin, end - begin, noises, input);
+                    }
+                });
+
+            if (copy_noises)
             {
-                belief_.location(i_sampl) = transition_->state(
-                    old_particles_[i_sampl], noises_[i_sampl], input);
+                noises_.swap(next_noises_);
+                noise_parents_.resize(0);
             }
 
             // compute likelihood ----------------------------------------------
-            bool update = (i_block == sampling_blocks_.size() - 1);
+            bool update = last_block;
             RealArray new_loglikes = sensor_->loglikes(
                 belief_.locations(), indices_, update);
 
             // update the weights and resample if necessary --------------------
+            const double ess = effective_sample_size();
             belief_.delta_log_prob_mass(new_loglikes - loglikes_);
             loglikes_ = new_loglikes;
+            block_statistics_.ess_drops[i_block] =
+                std::max(0., 1. - effective_sample_size() / ess);
 
             if (belief_.kl_given_uniform() > max_kl_divergence_)
             {
-                resample(belief_.size());
+                // the locations are propagated anew unless this is the last
+                // block
+                resample_ancestry(belief_.size(), update);
             }
+
+            update_block_seconds(block_begin);
         }
+
+        defer_skipped_blocks(executed);
     }
 
     void resample(const size_t& sample_count)
     {
-        IntArray indices(sample_count);
-        std::vector<Noise> noises(sample_count);
-        StateArray next_samples(sample_count);
-        RealArray loglikes(sample_count);
+        resample_ancestry(sample_count, true);
+    }
+
+    /// accessors **************************************************************
+    std::vector<std::vector<int>> sampling_blocks() const
+    {
+        return sampling_blocks_;
+    }
 
-        Belief new_belief(sample_count);
+    const std::shared_ptr<Executor>& executor() const { return executor_; }
 
-        for (size_t i = 0; i < sample_count; i++)
+    ResamplingScheme resampling_scheme() const { return resampling_scheme_; }
+
+    const BlockStatistics& block_statistics() const
+    {
+        return block_statistics_;
+    }
+
+    /// mutators ***************************************************************
+    void resampling_scheme(ResamplingScheme scheme)
+    {
+        resampling_scheme_ = scheme;
+    }
+
+    /**
+     * \brief Sets the executor running the noise sampling and propagation of
+     *        the particles. It is passed on to the sensor which evaluates the
+     *        likelihoods with it.
+     *
+     * The noise of each particle is taken from a counter based generator by
+     * its index, hence the filter is reproducible for a fixed seed regardless
+     * of the executor and its thread count.
+     */
+    void executor(const std::shared_ptr<Executor>& executor)
+    {
+        executor_ = executor;
+        sensor_->executor(executor);
+    }
+
+    /**
+     * \brief Replaces the sampling blocks, they are sampled in the given
+     *        order starting with the next filter step. The block statistics
+     *        are reset.
+     */
+    void sampling_blocks(const std::vector<std::vector<int>>& sampling_blocks)
+    {
+        // make sure sizes are consistent --------------------------------------
+        size_t dimension = 0;
+        for (size_t i = 0; i < sampling_blocks.size(); i++)
+        {
+            dimension += sampling_blocks[i].size();
+        }
+        if (dimension != transition_->noise_dimension())
         {
-            int index;
-            new_belief.location(i) = belief_.sample(index);
+            std::cout << "the dimension of the sampling blocks is " << dimension
+                      << " while the dimension of the noise is "
+                      << transition_->noise_dimension() << std::endl;
+            exit(-1);
+        }
 
-            indices[i] = indices_[index];
-            noises[i] = noises_[index];
-            next_samples[i] = old_particles_[index];
-            loglikes[i] = loglikes_[index];
+        sampling_blocks_ = sampling_blocks;
+        block_order_.resize(sampling_blocks_.size());
+        for (size_t i = 0; i < block_order_.size(); i++)
+        {
+            block_order_[i] = i;
         }
-        belief_ = new_belief;
-        indices_ = indices;
-        noises_ = noises;
-        old_particles_ = next_samples;
-        loglikes_ = loglikes;
+        reset_block_statistics();
     }
 
-    /// accessors **************************************************************
-    std::vector<std::vector<int>> sampling_blocks() const
+    /**
+     * \brief Replaces the sampling blocks like sampling_blocks(), but keeps
+     *        the blocks skipped in the last step in front
+     *
+     * New blocks which contain a noise dimension of a skipped block are
+     * sampled first in the next step, the relative order of the given blocks
+     * is kept otherwise. Hence repartitioning under a deadline does not
+     * starve the trailing blocks.
+     */
+    void update_sampling_blocks(
+        const std::vector<std::vector<int>>& sampling_blocks)
     {
-        return sampling_blocks_;
+        std::vector<char> skipped(transition_->noise_dimension(), 0);
+        for (int i_block : block_statistics_.last_skipped)
+        {
+            for (int i : sampling_blocks_[i_block]) skipped[i] = 1;
+        }
+
+        this->sampling_blocks(sampling_blocks);
+
+        std::stable_partition(
+            block_order_.begin(),
+            block_order_.end(),
+            [&](int i_block)
+            {
+                for (int i : sampling_blocks_[i_block])
+                {
+                    if (size_t(i) < skipped.size() && skipped[i]) return true;
+                }
+                return false;
+            });
+    }
+
+    void reset_block_statistics()
+    {
+        block_statistics_.frames = 0;
+        block_statistics_.late_frames = 0;
+        block_statistics_.skip_counts.assign(sampling_blocks_.size(), 0);
+        block_statistics_.last_skipped.clear();
+        block_statistics_.ess_drops.assign(sampling_blocks_.size(), -1);
+    }
+
+    /**
+     * \brief Restarts the noise and resampling random number sequences
+     */
+    void seed(unsigned int seed)
+    {
+        noise_generator_.seed(seed);
+        noise_stream_ = 0;
+        resampling_generator_.seed(seed);
     }
 
-    /// mutators ***************************************************************
     Belief& belief() { return belief_; }
     void set_particles(const std::vector<State>& samples)
     {
@@ -171,9 +359,7 @@ public:
 
         indices_ = IntArray::Zero(belief_.size());
         loglikes_ = RealArray::Zero(belief_.size());
-        noises_ = std::vector<Noise>(
-            belief_.size(), Noise::Zero(transition_->noise_dimension()));
-        old_particles_ = belief_.locations();
+        start_propagation();
 
         sensor_->reset();
     }
@@ -183,29 +369,409 @@ public:
         return sensor_;
     }
 
+    /// checkpoints ************************************************************
+    /**
+     * \brief Adds the particles, their weights and occlusion indices, the
+     *        sampling blocks, the positions of the random number sequences and
+     *        the state of the sensor to the checkpoint.
+     *
+     * The noises are drawn anew in each filter step and are not part of the
+     * state between steps.
+     */
+    void save(CheckpointWriter& checkpoint) const
+    {
+        const int count = belief_.size();
+        const int32_t dimension = transition_->state_dimension();
+        Matrix particles(dimension, count);
+        for (int i = 0; i < count; i++)
+        {
+            particles.col(i) = belief_.location(i);
+        }
+        RealArray log_weights = belief_.log_prob_mass();
+
+        std::vector<int32_t> blocks;
+        std::vector<int32_t> block_sizes;
+        for (const std::vector<int>& block : sampling_blocks_)
+        {
+            blocks.insert(blocks.end(), block.begin(), block.end());
+            block_sizes.push_back(block.size());
+        }
+
+        std::ostringstream generator;
+        generator << resampling_generator_;
+        const std::string generator_state = generator.str();
+
+        checkpoint.add("filter/state_dimension", &dimension, 1);
+        checkpoint.add("filter/particles", particles.data(), particles.size());
+        checkpoint.add("filter/log_weights", log_weights.data(), count);
+        checkpoint.add("filter/indices", indices_.data(), count);
+        checkpoint.add("filter/sampling_blocks", blocks);
+        checkpoint.add("filter/sampling_block_sizes", block_sizes);
+        checkpoint.add("filter/block_order", block_order_);
+        checkpoint.add("filter/block_seconds", &block_seconds_, 1);
+        checkpoint.add("filter/noise_stream", &noise_stream_, 1);
+        checkpoint.add(
+            "filter/resampling_generator",
+            reinterpret_cast<const uint8_t*>(generator_state.data()),
+            generator_state.size());
+
+        sensor_->save(checkpoint);
+    }
+
+    /**
+     * \brief Restores the state saved by save(). The seed of the noise
+     *        generator is not part of the checkpoint and has to be set to the
+     *        same value beforehand for an identical continuation. The filter
+     *        and the sensor are left unchanged if the checkpoint is rejected.
+     *
+     * \throws CheckpointException if the checkpoint does not match the models
+     */
+    void load(const CheckpointReader& checkpoint)
+    {
+        const int dimension =
+            checkpoint.vector<int32_t>("filter/state_dimension", 1)[0];
+        if (dimension != transition_->state_dimension())
+        {
+            throw CheckpointException("the state dimension " +
+                                      std::to_string(dimension) +
+                                      " does not match the transition");
+        }
+
+        size_t value_count;
+        const fl::Real* particles =
+            checkpoint.data<fl::Real>("filter/particles", value_count);
+        if (dimension <= 0 || value_count % dimension != 0)
+        {
+            throw CheckpointException(
+                "the particles do not match the state dimension " +
+                std::to_string(dimension));
+        }
+        const int count = value_count / dimension;
+        std::vector<fl::Real> log_weights =
+            checkpoint.vector<fl::Real>("filter/log_weights", count);
+
+        // the indices select the particle states of the sensor
+        std::vector<int32_t> indices =
+            checkpoint.vector<int32_t>("filter/indices", count);
+        const size_t state_count = sensor_->state_count(checkpoint);
+        for (int32_t index : indices)
+        {
+            if (index < 0 || size_t(index) >= state_count)
+            {
+                throw CheckpointException("invalid particle index " +
+                                          std::to_string(index));
+            }
+        }
+
+        std::vector<int32_t> blocks =
+            checkpoint.vector<int32_t>("filter/sampling_blocks");
+        std::vector<int32_t> block_sizes =
+            checkpoint.vector<int32_t>("filter/sampling_block_sizes");
+        std::vector<std::vector<int>> sampling_blocks;
+        size_t offset = 0;
+        for (int32_t size : block_sizes)
+        {
+            if (size < 0 || offset + size > blocks.size())
+            {
+                throw CheckpointException("invalid sampling blocks");
+            }
+            sampling_blocks.emplace_back(blocks.begin() + offset,
+                                         blocks.begin() + offset + size);
+            offset += size;
+        }
+
+        // the blocks have to cover each noise dimension exactly once and the
+        // order has to be a permutation of the blocks
+        const int noise_dimension = transition_->noise_dimension();
+        if (offset != blocks.size() ||
+            !is_permutation(blocks, noise_dimension))
+        {
+            throw CheckpointException(
+                "the sampling blocks do not match the noise dimension " +
+                std::to_string(noise_dimension));
+        }
+        std::vector<int32_t> block_order =
+            checkpoint.vector<int32_t>("filter/block_order");
+        if (!is_permutation(block_order, sampling_blocks.size()))
+        {
+            throw CheckpointException("invalid sampling block order");
+        }
+
+        const double block_seconds =
+            checkpoint.vector<double>("filter/block_seconds", 1)[0];
+        const uint64_t noise_stream =
+            checkpoint.vector<uint64_t>("filter/noise_stream", 1)[0];
+        std::vector<uint8_t> generator_state =
+            checkpoint.vector<uint8_t>("filter/resampling_generator");
+
+        // the sensor rejects the checkpoint without changes, hence the
+        // filter state is restored only once the sensor has been
+        sensor_->load(checkpoint);
+
+        belief_.set_uniform(count);
+        for (int i = 0; i < count; i++)
+        {
+            State& location = belief_.location(i);
+            location.resize(dimension);
+            location.col(0) = Eigen::Map<const Matrix>(
+                particles + i * dimension, dimension, 1);
+        }
+        belief_.delta_log_prob_mass(
+            Eigen::Map<const RealArray>(log_weights.data(), count));
+        indices_ = Eigen::Map<const IntArray>(indices.data(), count);
+        loglikes_ = RealArray::Zero(count);
+        start_propagation();
+
+        this->sampling_blocks(sampling_blocks);
+        block_order_ = block_order;
+        block_seconds_ = block_seconds;
+
+        noise_stream_ = noise_stream;
+        std::istringstream generator(
+            std::string(generator_state.begin(), generator_state.end()));
+        generator >> resampling_generator_;
+    }
+
     std::shared_ptr<Transition> transition()
     {
         return transition_;
     }
 
+private:
+    /**
+     * \brief Whether \a values contains each of 0, ..., \a count - 1 exactly
+     *        once
+     */
+    static bool is_permutation(const std::vector<int32_t>& values,
+                               size_t count)
+    {
+        if (values.size() != count) return false;
+
+        std::vector<char> found(count, 0);
+        for (int32_t value : values)
+        {
+            if (value < 0 || size_t(value) >= count || found[value])
+            {
+                return false;
+            }
+            found[value] = 1;
+        }
+        return true;
+    }
+
+    /**
+     * \brief Whether the current and one more sampling block complete before
+     *        the deadline, judged by the average duration of a block
+     */
+    bool next_block_fits(const Clock::time_point& now,
+                         const Clock::time_point& deadline) const
+    {
+        if (deadline == Clock::time_point::max()) return true;
+
+        const std::chrono::duration<double> remaining = deadline - now;
+        return remaining.count() >= 2 * block_seconds_;
+    }
+
+    double effective_sample_size() const
+    {
+        RealArray weights = belief_.log_prob_mass().exp();
+        return weights.sum() * weights.sum() / weights.square().sum();
+    }
+
+    void update_block_seconds(const Clock::time_point& block_begin)
+    {
+        const double rate = 0.2;
+        double seconds = std::chrono::duration<double>(Clock::now() -
+                                                       block_begin)
+                             .count();
+        block_seconds_ = block_seconds_ > 0
+                             ? (1 - rate) * block_seconds_ + rate * seconds
+                             : seconds;
+    }
+
+    /**
+     * \brief Moves the blocks which have not been executed in this step to
+     *        the front of the order and records them
+     */
+    void defer_skipped_blocks(size_t executed)
+    {
+        block_statistics_.frames++;
+        block_statistics_.last_skipped.assign(block_order_.begin() + executed,
+                                              block_order_.end());
+        if (block_statistics_.last_skipped.empty()) return;
+
+        block_statistics_.late_frames++;
+        for (int i_block : block_statistics_.last_skipped)
+        {
+            block_statistics_.skip_counts[i_block]++;
+        }
+        std::rotate(block_order_.begin(),
+                    block_order_.begin() + executed,
+                    block_order_.end());
+    }
+
+    /**
+     * \brief Propagates the \a count particles starting at \a begin by a
+     *        single product of the batch transition
+     */
+    void propagate_batch(int begin,
+                         int count,
+                         const Matrix& noises,
+                         const Input& input)
+    {
+        if (parents_shared_)
+        {
+            for (int i = begin; i < begin + count; i++)
+            {
+                parent_states_.col(i) = old_states_.col(parents_[i]);
+            }
+        }
+        const Matrix& prev_states = parents_shared_ ? parent_states_
+                                                    : old_states_;
+
+        batch_transition_->states(prev_states.middleCols(begin, count),
+                                  noises.middleCols(begin, count),
+                                  input,
+                                  states_.middleCols(begin, count));
+
+        for (int i = begin; i < begin + count; i++)
+        {
+            // assign through a block to reuse the memory of the location
+            State& location = belief_.location(i);
+            location.resize(states_.rows());
+            location.col(0) = states_.col(i);
+        }
+    }
+
+    /**
+     * \brief Copies the current particles into the columns of the old states
+     *        and clears their noises
+     */
+    void start_propagation()
+    {
+        const int count = belief_.size();
+        old_states_.resize(transition_->state_dimension(), count);
+        for (int i = 0; i < count; i++)
+        {
+            old_states_.col(i) = belief_.location(i);
+        }
+        parents_ = IntArray::LinSpaced(count, 0, count - 1);
+        parents_shared_ = false;
+        if (batch_transition_)
+        {
+            states_.resize(old_states_.rows(), count);
+        }
+
+        noises_.setZero(transition_->noise_dimension(), count);
+        noise_parents_.resize(0);
+    }
+
+    /**
+     * \brief Resamples the particles without copying their payloads
+     *
+     * Only the parent indices into the old particles, the noises and the
+     * occlusion maps of the sensor are composed with the ancestors. The noises
+     * are copied lazily in the next propagation, the locations only if
+     * \a copy_locations is set.
+     */
+    void resample_ancestry(size_t sample_count, bool copy_locations)
+    {
+        // parent indices from a single sweep over the cumulative weights
+        Eigen::ArrayXd weights =
+            belief_.log_prob_mass().exp().template cast<double>();
+        std::vector<int> ancestors;
+        resample_ancestors(resampling_scheme_,
+                           weights,
+                           sample_count,
+                           resampling_generator_,
+                           ancestors);
+
+        const bool noises_copied = noise_parents_.size() == 0;
+        IntArray indices(sample_count);
+        IntArray parents(sample_count);
+        IntArray noise_parents(sample_count);
+        RealArray loglikes(sample_count);
+        for (size_t i = 0; i < sample_count; i++)
+        {
+            const int index = ancestors[i];
+            indices[i] = indices_[index];
+            parents[i] = parents_[index];
+            noise_parents[i] = noises_copied ? index : noise_parents_[index];
+            loglikes[i] = loglikes_[index];
+        }
+        indices_.swap(indices);
+        parents_.swap(parents);
+        parents_shared_ = true;
+        if (batch_transition_)
+        {
+            parent_states_.resize(old_states_.rows(), sample_count);
+            states_.resize(old_states_.rows(), sample_count);
+        }
+        noise_parents_.swap(noise_parents);
+        loglikes_.swap(loglikes);
+
+        if (copy_locations)
+        {
+            StateArray locations(sample_count);
+            for (size_t i = 0; i < sample_count; i++)
+            {
+                locations[i] = belief_.location(ancestors[i]);
+            }
+            belief_.set_uniform(sample_count);
+            for (size_t i = 0; i < sample_count; i++)
+            {
+                belief_.location(i) = locations[i];
+            }
+        }
+        else
+        {
+            belief_.set_uniform(sample_count);
+        }
+    }
+
 private:
     /// member variables *******************************************************
     Belief belief_;
     IntArray indices_;
 
-    std::vector<Noise> noises_;
-    StateArray old_particles_;
+    // states at the beginning of the frame and noises in structure of arrays
+    // layout, one column per particle. Resampled particles share them through
+    // their parent indices. An empty noise_parents_ denotes one noise per
+    // particle.
+    Matrix old_states_;
+    IntArray parents_;
+    bool parents_shared_;
+    Matrix noises_;
+    Matrix next_noises_;
+    IntArray noise_parents_;
+
+    // work buffers of the batch transition
+    Matrix parent_states_;
+    Matrix states_;
     RealArray loglikes_;
 
     // models
     std::shared_ptr<Sensor> sensor_;
     std::shared_ptr<Transition> transition_;
+    std::shared_ptr<BatchTransition<Input>> batch_transition_;
 
     // parameters
     std::vector<std::vector<int>> sampling_blocks_;
+
+    // sampling blocks in the order of the next step, blocks skipped at a
+    // deadline come first
+    std::vector<int> block_order_;
+    double block_seconds_;
+    BlockStatistics block_statistics_;
     fl::Real max_kl_divergence_;
+    ResamplingScheme resampling_scheme_;
+
+    // parallel execution
+    std::shared_ptr<Executor> executor_;
 
-    // distribution for sampling
-    fl::Gaussian<Eigen::Matrix<fl::Real, 1, 1>> unit_gaussian_;
+    // random numbers, the noise of each sampling block is one stream
+    GaussianNoiseGenerator noise_generator_;
+    uint64_t noise_stream_;
+    std::mt19937 resampling_generator_;
 };
 }
@@ -0,0 +1,146 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file resampling.cpp
+ * \date October 2016
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include <dbot/filter/resampling.h>
+
+namespace dbot
+{
+namespace
+{
+/**
+ * \internal
+ * Assigns the positions (k + u_k) / count, k = 0, ..., count - 1, scaled to
+ * the total weight to the particles covering them. The offsets u_k in [0, 1)
+ * are the same for all k if \a stratified is false.
+ */
+void sweep(const Eigen::ArrayXd& weights,
+           double total_weight,
+           size_t count,
+           bool stratified,
+           std::mt19937& generator,
+           std::vector<int>& ancestors)
+{
+    std::uniform_real_distribution<double> uniform(0., 1.);
+
+    const double step = total_weight / count;
+    const int last = int(weights.size()) - 1;
+    double offset = uniform(generator);
+    double cumulative = weights[0];
+    int i = 0;
+
+    for (size_t k = 0; k < count; ++k)
+    {
+        if (stratified) offset = uniform(generator);
+
+        const double position = (k + offset) * step;
+        while (position >= cumulative && i < last)
+        {
+            cumulative += weights[++i];
+        }
+        ancestors.push_back(i);
+    }
+}
+}
+
+void resample_ancestors(ResamplingScheme scheme,
+                        const Eigen::ArrayXd& weights,
+                        size_t sample_count,
+                        std::mt19937& generator,
+                        std::vector<int>& ancestors)
+{
+    const double total_weight = weights.sum();
+    if (!(total_weight > 0) || !std::isfinite(total_weight))
+    {
+        std::cout << "cannot resample particles of total weight "
+                  << total_weight << std::endl;
+        exit(-1);
+    }
+
+    ancestors.clear();
+    ancestors.reserve(sample_count);
+
+    switch (scheme)
+    {
+        case ResamplingScheme::Systematic:
+            sweep(weights,
+                  total_weight,
+                  sample_count,
+                  false,
+                  generator,
+                  ancestors);
+            break;
+
+        case ResamplingScheme::Stratified:
+            sweep(weights,
+                  total_weight,
+                  sample_count,
+                  true,
+                  generator,
+                  ancestors);
+            break;
+
+        case ResamplingScheme::Residual:
+        {
+            // deterministic copies and the residual weights left over
+            const double scale = sample_count / total_weight;
+            std::vector<int> copies(weights.size());
+            Eigen::ArrayXd residuals(weights.size());
+            size_t copy_count = 0;
+            for (int i = 0; i < weights.size(); ++i)
+            {
+                const double expected = weights[i] * scale;
+                copies[i] = int(std::floor(expected));
+                residuals[i] = expected - copies[i];
+                copy_count += copies[i];
+            }
+            size_t residual_count =
+                copy_count < sample_count ? sample_count - copy_count : 0;
+
+            std::vector<int> residual_ancestors;
+            residual_ancestors.reserve(residual_count);
+            if (residual_count > 0)
+            {
+                sweep(residuals,
+                      residuals.sum(),
+                      residual_count,
+                      false,
+                      generator,
+                      residual_ancestors);
+            }
+
+            // merge both in ascending order
+            size_t r = 0;
+            for (int i = 0; i < weights.size(); ++i)
+            {
+                ancestors.insert(ancestors.end(), copies[i], i);
+                while (r < residual_ancestors.size() &&
+                       residual_ancestors[r] == i)
+                {
+                    ancestors.push_back(i);
+                    ++r;
+                }
+            }
+            break;
+        }
+    }
+}
+}
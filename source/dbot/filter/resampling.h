@@ -0,0 +1,63 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file resampling.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <random>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace dbot
+{
+/**
+ * \brief Resampling schemes of the particle filters
+ *
+ * All schemes place sorted positions in [0, 1) and assign them to the
+ * particles in a single sweep over the cumulative weights. They run in
+ * O(N + M) for N particles and M samples and have a lower variance than
+ * drawing the samples independently.
+ *  - Systematic uses a single uniform offset for all positions.
+ *  - Stratified draws an independent offset within each of the M strata.
+ *  - Residual copies each particle floor(M w) times and distributes the
+ *    remaining samples systematically on the residual weights.
+ */
+enum class ResamplingScheme
+{
+    Systematic,
+    Stratified,
+    Residual
+};
+
+/**
+ * \brief Draws the parent indices of \a sample_count new particles
+ *
+ * \param [in]  scheme       resampling scheme
+ * \param [in]  weights      non-negative particle weights, they need not be
+ *                           normalized but must not all be zero
+ * \param [in]  sample_count number of new particles
+ * \param [in]  generator    random number generator
+ * \param [out] ancestors    parent index of each new particle in ascending
+ *                           order
+ */
+void resample_ancestors(ResamplingScheme scheme,
+                        const Eigen::ArrayXd& weights,
+                        size_t sample_count,
+                        std::mt19937& generator,
+                        std::vector<int>& ancestors);
+}
@@ -0,0 +1,207 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file resampling_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+
+#include <dbot/filter/resampling.h>
+
+namespace
+{
+const dbot::ResamplingScheme schemes[] = {dbot::ResamplingScheme::Systematic,
+                                          dbot::ResamplingScheme::Stratified,
+                                          dbot::ResamplingScheme::Residual};
+
+const char* scheme_names[] = {"systematic", "stratified", "residual"};
+
+Eigen::ArrayXd random_weights(int count, std::mt19937& generator)
+{
+    std::exponential_distribution<double> exponential(1.);
+    Eigen::ArrayXd weights(count);
+    for (int i = 0; i < count; ++i)
+    {
+        // a few particles carry most of the weight, some none at all
+        weights[i] = i % 7 == 3 ? 0. : std::pow(exponential(generator), 4);
+    }
+    return weights;
+}
+
+std::vector<int> offspring_counts(const std::vector<int>& ancestors,
+                                  int particle_count)
+{
+    std::vector<int> counts(particle_count, 0);
+    for (int ancestor : ancestors) counts[ancestor]++;
+    return counts;
+}
+
+/**
+ * Reference: independent draws by binary search on the cumulative weights,
+ * O(M log N)
+ */
+void resample_multinomial(const Eigen::ArrayXd& weights,
+                          size_t sample_count,
+                          std::mt19937& generator,
+                          std::vector<int>& ancestors)
+{
+    std::vector<double> cumulative(weights.size());
+    std::partial_sum(weights.data(),
+                     weights.data() + weights.size(),
+                     cumulative.begin());
+    std::uniform_real_distribution<double> uniform(0., cumulative.back());
+
+    ancestors.resize(sample_count);
+    for (size_t k = 0; k < sample_count; ++k)
+    {
+        ancestors[k] = std::min<int>(
+            std::upper_bound(
+                cumulative.begin(), cumulative.end(), uniform(generator)) -
+                cumulative.begin(),
+            weights.size() - 1);
+    }
+}
+}
+
+TEST(ResamplingTests, ancestors_are_sorted_and_have_weight)
+{
+    std::mt19937 generator(1);
+    Eigen::ArrayXd weights = random_weights(500, generator);
+
+    for (auto scheme : schemes)
+    {
+        for (size_t sample_count : {1, 37, 500, 2000})
+        {
+            std::vector<int> ancestors;
+            dbot::resample_ancestors(
+                scheme, weights, sample_count, generator, ancestors);
+
+            ASSERT_EQ(ancestors.size(), sample_count);
+            EXPECT_TRUE(std::is_sorted(ancestors.begin(), ancestors.end()));
+            for (int ancestor : ancestors)
+            {
+                ASSERT_GE(ancestor, 0);
+                ASSERT_LT(ancestor, weights.size());
+                EXPECT_GT(weights[ancestor], 0.);
+            }
+        }
+    }
+}
+
+TEST(ResamplingTests, systematic_and_residual_offspring_counts_are_tight)
+{
+    std::mt19937 generator(2);
+    Eigen::ArrayXd weights = random_weights(300, generator);
+    const size_t sample_count = 1000;
+    Eigen::ArrayXd expected = weights * (sample_count / weights.sum());
+
+    for (auto scheme : {dbot::ResamplingScheme::Systematic,
+                        dbot::ResamplingScheme::Residual})
+    {
+        for (int trial = 0; trial < 20; ++trial)
+        {
+            std::vector<int> ancestors;
+            dbot::resample_ancestors(
+                scheme, weights, sample_count, generator, ancestors);
+            std::vector<int> counts =
+                offspring_counts(ancestors, weights.size());
+
+            for (int i = 0; i < weights.size(); ++i)
+            {
+                EXPECT_GE(counts[i], std::floor(expected[i] - 1e-9));
+                EXPECT_LE(counts[i], std::ceil(expected[i] + 1e-9));
+            }
+        }
+    }
+}
+
+TEST(ResamplingTests, offspring_counts_are_unbiased)
+{
+    std::mt19937 generator(3);
+    Eigen::ArrayXd weights = random_weights(50, generator);
+    const size_t sample_count = 50;
+    const int trials = 4000;
+    Eigen::ArrayXd expected = weights * (sample_count / weights.sum());
+
+    for (int s = 0; s < 3; ++s)
+    {
+        Eigen::ArrayXd mean = Eigen::ArrayXd::Zero(weights.size());
+        for (int trial = 0; trial < trials; ++trial)
+        {
+            std::vector<int> ancestors;
+            dbot::resample_ancestors(
+                schemes[s], weights, sample_count, generator, ancestors);
+            for (int ancestor : ancestors) mean[ancestor] += 1. / trials;
+        }
+
+        for (int i = 0; i < weights.size(); ++i)
+        {
+            // the variance of a count is at most that of a binomial one
+            double variance = expected[i] * (1. - expected[i] / sample_count);
+            double tolerance = 5. * std::sqrt(variance / trials) + 1e-9;
+            EXPECT_NEAR(mean[i], expected[i], tolerance) << scheme_names[s];
+        }
+    }
+}
+
+TEST(ResamplingTests, benchmark)
+{
+    std::mt19937 generator(4);
+
+    for (int particle_count : {100, 1000, 10000})
+    {
+        Eigen::ArrayXd weights = random_weights(particle_count, generator);
+        const int repetitions = 2000000 / particle_count;
+        std::vector<int> ancestors;
+
+        std::cout << particle_count << " particles:";
+        for (int s = -1; s < 3; ++s)
+        {
+            auto begin = std::chrono::steady_clock::now();
+            for (int r = 0; r < repetitions; ++r)
+            {
+                if (s < 0)
+                {
+                    resample_multinomial(
+                        weights, particle_count, generator, ancestors);
+                }
+                else
+                {
+                    dbot::resample_ancestors(schemes[s],
+                                             weights,
+                                             particle_count,
+                                             generator,
+                                             ancestors);
+                }
+            }
+            double seconds = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - begin)
+                                 .count();
+
+            std::cout << " " << (s < 0 ? "multinomial" : scheme_names[s])
+                      << " " << 1e9 * seconds / repetitions / particle_count
+                      << " ns";
+        }
+        std::cout << " per particle" << std::endl;
+
+        EXPECT_EQ(ancestors.size(), size_t(particle_count));
+    }
+}
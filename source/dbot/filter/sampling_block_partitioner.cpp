@@ -0,0 +1,184 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file sampling_block_partitioner.cpp
+ * \date October 2016
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+
+#include <dbot/filter/sampling_block_partitioner.h>
+
+namespace dbot
+{
+SamplingBlockPartitioner::SamplingBlockPartitioner(
+    const std::vector<std::vector<int>>& atoms,
+    const std::vector<std::vector<int>>& partition,
+    const Parameters& parameters)
+    : atoms_(atoms),
+      partition_(partition),
+      drops_(partition.size(), -1),
+      parameters_(parameters),
+      steps_(0)
+{
+    if (parameters_.merge_threshold > parameters_.split_threshold)
+    {
+        std::cout << "the merge threshold " << parameters_.merge_threshold
+                  << " exceeds the split threshold "
+                  << parameters_.split_threshold << std::endl;
+        exit(-1);
+    }
+}
+
+bool SamplingBlockPartitioner::update(const std::vector<double>& ess_drops)
+{
+    if (ess_drops.size() != partition_.size())
+    {
+        std::cout << "got " << ess_drops.size() << " drops for "
+                  << partition_.size() << " sampling blocks" << std::endl;
+        exit(-1);
+    }
+
+    const double rate = parameters_.update_rate;
+    for (size_t i = 0; i < drops_.size(); i++)
+    {
+        if (ess_drops[i] < 0) continue;
+
+        drops_[i] = drops_[i] >= 0
+                        ? (1 - rate) * drops_[i] + rate * ess_drops[i]
+                        : ess_drops[i];
+    }
+
+    if (++steps_ < parameters_.period) return false;
+
+    steps_ = 0;
+    return repartition();
+}
+
+bool SamplingBlockPartitioner::repartition()
+{
+    std::vector<std::vector<int>> partition;
+    std::vector<double> drops;
+
+    // split strongly constrained blocks in halves. The effective sample size
+    // ratios of independent halves multiply, hence each half retains the
+    // square root of the ratio.
+    for (size_t i = 0; i < partition_.size(); i++)
+    {
+        const std::vector<int>& block = partition_[i];
+        if (drops_[i] <= parameters_.split_threshold || block.size() < 2)
+        {
+            partition.push_back(block);
+            drops.push_back(drops_[i]);
+            continue;
+        }
+
+        const double drop = 1 - std::sqrt(1 - drops_[i]);
+        const size_t half = block.size() / 2;
+        partition.emplace_back(block.begin(), block.begin() + half);
+        partition.emplace_back(block.begin() + half, block.end());
+        drops.push_back(drop);
+        drops.push_back(drop);
+    }
+
+    // merge the two least constrained blocks as long as both are below the
+    // merge threshold and their joint drop below the split threshold. Blocks
+    // which have not been sampled yet are left as they are.
+    while (true)
+    {
+        const size_t none = partition.size();
+        size_t first = none, second = none;
+        for (size_t i = 0; i < drops.size(); i++)
+        {
+            if (drops[i] < 0) continue;
+
+            if (first == none || drops[i] < drops[first])
+            {
+                second = first;
+                first = i;
+            }
+            else if (second == none || drops[i] < drops[second])
+            {
+                second = i;
+            }
+        }
+        if (second == none) break;
+
+        const double joint = 1 - (1 - drops[first]) * (1 - drops[second]);
+        if (drops[second] >= parameters_.merge_threshold ||
+            joint > parameters_.split_threshold)
+        {
+            break;
+        }
+
+        std::vector<int>& merged = partition[std::min(first, second)];
+        const std::vector<int>& other = partition[std::max(first, second)];
+        merged.insert(merged.end(), other.begin(), other.end());
+        std::sort(merged.begin(), merged.end());
+        drops[std::min(first, second)] = joint;
+        partition.erase(partition.begin() + std::max(first, second));
+        drops.erase(drops.begin() + std::max(first, second));
+    }
+
+    // most constrained blocks first
+    std::vector<size_t> order(partition.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(),
+                     order.end(),
+                     [&](size_t a, size_t b) { return drops[a] > drops[b]; });
+
+    std::vector<std::vector<int>> sorted_partition;
+    std::vector<double> sorted_drops;
+    for (size_t i : order)
+    {
+        sorted_partition.push_back(partition[i]);
+        sorted_drops.push_back(drops[i]);
+    }
+
+    const bool changed = sorted_partition != partition_;
+    partition_.swap(sorted_partition);
+    drops_.swap(sorted_drops);
+
+    return changed;
+}
+
+std::vector<std::vector<int>> SamplingBlockPartitioner::sampling_blocks() const
+{
+    std::vector<std::vector<int>> blocks(partition_.size());
+    for (size_t i = 0; i < partition_.size(); i++)
+    {
+        for (int atom : partition_[i])
+        {
+            blocks[i].insert(
+                blocks[i].end(), atoms_[atom].begin(), atoms_[atom].end());
+        }
+    }
+
+    return blocks;
+}
+
+const std::vector<std::vector<int>>& SamplingBlockPartitioner::partition()
+    const
+{
+    return partition_;
+}
+
+const std::vector<double>& SamplingBlockPartitioner::drops() const
+{
+    return drops_;
+}
+}
@@ -0,0 +1,104 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file sampling_block_partitioner.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief Adapts the sampling blocks of the coordinate particle filter to the
+ *        weight degeneracy they cause
+ *
+ * The noise dimensions are grouped into atoms, e.g. the translation and the
+ * rotation of each part, and each sampling block is a set of atoms. Every
+ * block costs one likelihood evaluation per filter step, and the relative
+ * drop of the effective sample size it causes measures how strongly the
+ * observation constrains its coordinates.
+ *
+ * Periodically, blocks whose drop exceeds the split threshold are halved,
+ * since sampling many constrained coordinates jointly degenerates the
+ * particle set. Pairs of blocks with drops below the merge threshold are
+ * joined to save likelihood evaluations, as long as the joint drop stays
+ * below the split threshold. Finally the blocks are ordered by decreasing
+ * drop such that the most constrained coordinates are resolved first.
+ */
+class SamplingBlockPartitioner
+{
+public:
+    struct Parameters
+    {
+        /// relative drop of the effective sample size above which a block is
+        /// split
+        double split_threshold;
+        /// drop below which blocks are merged
+        double merge_threshold;
+        /// update rate of the moving averages of the drops
+        double update_rate;
+        /// number of filter steps between two repartitions
+        int period;
+    };
+
+public:
+    /**
+     * \param atoms     noise dimensions of each atom
+     * \param partition atom indices of each initial sampling block
+     */
+    SamplingBlockPartitioner(const std::vector<std::vector<int>>& atoms,
+                             const std::vector<std::vector<int>>& partition,
+                             const Parameters& parameters);
+
+    /**
+     * \brief Accumulates the drops of the effective sample size of the last
+     *        filter step and repartitions every period steps
+     *
+     * \param ess_drops drop of each current sampling block, negative for
+     *                  blocks which have not been sampled
+     * \return whether the sampling blocks have changed
+     */
+    bool update(const std::vector<double>& ess_drops);
+
+    /**
+     * \return the noise dimensions of the current sampling blocks in their
+     *         sampling order
+     */
+    std::vector<std::vector<int>> sampling_blocks() const;
+
+    /**
+     * \return the atom indices of the current sampling blocks
+     */
+    const std::vector<std::vector<int>>& partition() const;
+
+    /**
+     * \return the averaged drop of each current sampling block, negative if
+     *         it has not been sampled yet
+     */
+    const std::vector<double>& drops() const;
+
+private:
+    bool repartition();
+
+private:
+    std::vector<std::vector<int>> atoms_;
+    std::vector<std::vector<int>> partition_;
+    std::vector<double> drops_;
+    Parameters parameters_;
+    int steps_;
+};
+}
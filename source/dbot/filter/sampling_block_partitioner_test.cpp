@@ -0,0 +1,106 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file sampling_block_partitioner_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/filter/sampling_block_partitioner.h>
+
+typedef std::vector<std::vector<int>> Blocks;
+
+class SamplingBlockPartitionerTests : public ::testing::Test
+{
+protected:
+    SamplingBlockPartitionerTests()
+    {
+        // translation and rotation of three parts
+        atoms_ = {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}, {9, 10, 11}, {12, 13, 14},
+                  {15, 16, 17}};
+        parameters_.split_threshold = 0.6;
+        parameters_.merge_threshold = 0.2;
+        parameters_.update_rate = 0.5;
+        parameters_.period = 2;
+    }
+
+    Blocks atoms_;
+    dbot::SamplingBlockPartitioner::Parameters parameters_;
+};
+
+TEST_F(SamplingBlockPartitionerTests, repartitions_every_period)
+{
+    dbot::SamplingBlockPartitioner partitioner(
+        atoms_, {{0, 1}, {2, 3}, {4, 5}}, parameters_);
+
+    EXPECT_FALSE(partitioner.update({0.3, 0.4, 0.5}));
+    EXPECT_EQ(partitioner.partition(), Blocks({{0, 1}, {2, 3}, {4, 5}}));
+
+    // averages 0.3, 0.4, 0.5, only reordered
+    EXPECT_TRUE(partitioner.update({0.3, 0.4, 0.5}));
+    EXPECT_EQ(partitioner.partition(), Blocks({{4, 5}, {2, 3}, {0, 1}}));
+
+    EXPECT_FALSE(partitioner.update({0.5, 0.4, 0.3}));
+    EXPECT_FALSE(partitioner.update({0.5, 0.4, 0.3}));
+}
+
+TEST_F(SamplingBlockPartitionerTests, splits_degenerate_blocks)
+{
+    dbot::SamplingBlockPartitioner partitioner(
+        atoms_, {{0, 1}, {2, 3}, {4, 5}}, parameters_);
+
+    partitioner.update({0.3, 0.84, 0.5});
+    EXPECT_TRUE(partitioner.update({0.3, 0.84, 0.5}));
+
+    // each half of the split block keeps 1 - sqrt(1 - 0.84) = 0.6
+    EXPECT_EQ(partitioner.partition(), Blocks({{2}, {3}, {4, 5}, {0, 1}}));
+    EXPECT_NEAR(partitioner.drops()[0], 0.6, 1e-12);
+    EXPECT_NEAR(partitioner.drops()[1], 0.6, 1e-12);
+
+    EXPECT_EQ(partitioner.sampling_blocks(),
+              Blocks({{6, 7, 8},
+                      {9, 10, 11},
+                      {12, 13, 14, 15, 16, 17},
+                      {0, 1, 2, 3, 4, 5}}));
+}
+
+TEST_F(SamplingBlockPartitionerTests, merges_weak_blocks)
+{
+    dbot::SamplingBlockPartitioner partitioner(
+        atoms_, {{0, 1}, {2, 3}, {4, 5}}, parameters_);
+
+    partitioner.update({0.1, 0.5, 0.15});
+    EXPECT_TRUE(partitioner.update({0.1, 0.5, 0.15}));
+
+    // joint drop 1 - 0.9 * 0.85 = 0.235
+    EXPECT_EQ(partitioner.partition(), Blocks({{2, 3}, {0, 1, 4, 5}}));
+    EXPECT_NEAR(partitioner.drops()[1], 0.235, 1e-12);
+
+    // the merged block is no longer below the merge threshold
+    partitioner.update({0.5, 0.235});
+    EXPECT_FALSE(partitioner.update({0.5, 0.235}));
+}
+
+TEST_F(SamplingBlockPartitionerTests, keeps_blocks_which_were_not_sampled)
+{
+    dbot::SamplingBlockPartitioner partitioner(
+        atoms_, {{0, 1}, {2, 3}, {4, 5}}, parameters_);
+
+    partitioner.update({0.1, -1, 0.7});
+    EXPECT_TRUE(partitioner.update({0.1, -1, 0.7}));
+
+    EXPECT_EQ(partitioner.partition(), Blocks({{4}, {5}, {0, 1}, {2, 3}}));
+    EXPECT_LT(partitioner.drops()[3], 0);
+}
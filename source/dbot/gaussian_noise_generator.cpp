@@ -0,0 +1,142 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file gaussian_noise_generator.cpp
+ * \date October 2016
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <dbot/gaussian_noise_generator.h>
+
+namespace dbot
+{
+namespace
+{
+/**
+ * \internal
+ * Number of counters transformed per batch. The uniforms of a batch are
+ * computed first and transformed in a separate loop, which keeps the
+ * transcendental functions out of the integer mixing.
+ */
+const size_t batch_size = 64;
+
+inline void multiply(uint32_t a, uint32_t b, uint32_t& high, uint32_t& low)
+{
+    uint64_t product = uint64_t(a) * uint64_t(b);
+    high = uint32_t(product >> 32);
+    low = uint32_t(product);
+}
+
+/**
+ * \internal
+ * Uniform double in [0, 1) of 53 random bits
+ */
+inline double uniform(uint32_t high, uint32_t low)
+{
+    return ((uint64_t(high) << 21) ^ (low >> 11)) * (1.0 / 9007199254740992.0);
+}
+}
+
+std::array<uint32_t, 4> philox4x32(const std::array<uint32_t, 4>& counter,
+                                   const std::array<uint32_t, 2>& key)
+{
+    std::array<uint32_t, 4> x = counter;
+    std::array<uint32_t, 2> k = key;
+
+    for (int round = 0; round < 10; ++round)
+    {
+        uint32_t high0, low0, high1, low1;
+        multiply(0xD2511F53, x[0], high0, low0);
+        multiply(0xCD9E8D57, x[2], high1, low1);
+
+        x = {{high1 ^ x[1] ^ k[0], low1, high0 ^ x[3] ^ k[1], low0}};
+
+        k[0] += 0x9E3779B9;
+        k[1] += 0xBB67AE85;
+    }
+
+    return x;
+}
+
+GaussianNoiseGenerator::GaussianNoiseGenerator(uint64_t seed)
+{
+    this->seed(seed);
+}
+
+void GaussianNoiseGenerator::seed(uint64_t seed)
+{
+    key_ = {{uint32_t(seed), uint32_t(seed >> 32)}};
+}
+
+void GaussianNoiseGenerator::fill(uint64_t stream,
+                                  uint64_t offset,
+                                  size_t count,
+                                  double* values) const
+{
+    const double two_pi = 6.283185307179586;
+
+    double radius[batch_size];
+    double angle[batch_size];
+
+    // each counter yields one pair of variates
+    uint64_t pair = offset / 2;
+    const uint64_t end = offset + count;
+    size_t written = 0;
+
+    while (written < count)
+    {
+        const size_t pairs =
+            std::min<uint64_t>(batch_size, (end + 1) / 2 - pair);
+
+        for (size_t j = 0; j < pairs; ++j)
+        {
+            const uint64_t n = pair + j;
+            std::array<uint32_t, 4> bits =
+                philox4x32({{uint32_t(n),
+                             uint32_t(n >> 32),
+                             uint32_t(stream),
+                             uint32_t(stream >> 32)}},
+                           key_);
+
+            // 1 - u lies in (0, 1], hence the logarithm is finite
+            radius[j] = 1.0 - uniform(bits[0], bits[1]);
+            angle[j] = two_pi * uniform(bits[2], bits[3]);
+        }
+
+        for (size_t j = 0; j < pairs; ++j)
+        {
+            radius[j] = std::sqrt(-2.0 * std::log(radius[j]));
+        }
+
+        for (size_t j = 0; j < pairs; ++j)
+        {
+            // variates 2 (pair + j) and 2 (pair + j) + 1
+            const uint64_t n = 2 * (pair + j);
+            if (n >= offset && n < end)
+            {
+                values[n - offset] = radius[j] * std::cos(angle[j]);
+            }
+            if (n + 1 >= offset && n + 1 < end)
+            {
+                values[n + 1 - offset] = radius[j] * std::sin(angle[j]);
+            }
+        }
+
+        written = std::min<uint64_t>(2 * (pair + pairs), end) - offset;
+        pair += pairs;
+    }
+}
+}
@@ -0,0 +1,66 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file gaussian_noise_generator.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace dbot
+{
+/**
+ * \brief Philox4x32-10 counter based random number generator (Salmon et
+ *        al., Parallel Random Numbers: As Easy as 1, 2, 3, 2011)
+ *
+ * \return four random 32 bit words of the given counter and key
+ */
+std::array<uint32_t, 4> philox4x32(const std::array<uint32_t, 4>& counter,
+                                   const std::array<uint32_t, 2>& key);
+
+/**
+ * \brief Generator of standard normal variates in bulk
+ *
+ * The variates form numbered streams of random access sequences. Variate n
+ * of a stream is computed by the Box-Muller transform from the Philox output
+ * of counter (n / 2, stream) and the seed as key. Since the result depends on
+ * these numbers only, any range of a stream can be generated independently,
+ * e.g. by different threads, and concatenates to the same sequence.
+ *
+ * The generator has no mutable state and may be shared between threads.
+ */
+class GaussianNoiseGenerator
+{
+public:
+    explicit GaussianNoiseGenerator(uint64_t seed = 0);
+
+    void seed(uint64_t seed);
+
+    /**
+     * \brief Writes the variates [offset, offset + count) of \a stream to
+     *        \a values
+     */
+    void fill(uint64_t stream,
+              uint64_t offset,
+              size_t count,
+              double* values) const;
+
+private:
+    std::array<uint32_t, 2> key_;
+};
+}
@@ -0,0 +1,103 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file gaussian_noise_generator_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include <dbot/gaussian_noise_generator.h>
+
+TEST(GaussianNoiseGeneratorTests, philox_known_answers)
+{
+    // known answer vectors of the Random123 library
+    typedef std::array<uint32_t, 4> Words;
+
+    EXPECT_EQ(dbot::philox4x32({{0, 0, 0, 0}}, {{0, 0}}),
+              Words({{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}}));
+    EXPECT_EQ(
+        dbot::philox4x32({{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}},
+                         {{0xffffffff, 0xffffffff}}),
+        Words({{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}}));
+    EXPECT_EQ(
+        dbot::philox4x32({{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}},
+                         {{0xa4093822, 0x299f31d0}}),
+        Words({{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}}));
+}
+
+TEST(GaussianNoiseGeneratorTests, ranges_concatenate_to_the_stream)
+{
+    dbot::GaussianNoiseGenerator generator(42);
+
+    std::vector<double> all(1000);
+    generator.fill(7, 0, all.size(), all.data());
+
+    // split at odd and even offsets into pieces of different lengths
+    std::vector<double> pieces(all.size());
+    size_t offset = 0;
+    for (size_t length : {1, 2, 3, 64, 127, 128, 129, 300, 246})
+    {
+        generator.fill(7, offset, length, pieces.data() + offset);
+        offset += length;
+    }
+    ASSERT_EQ(offset, all.size());
+
+    for (size_t i = 0; i < all.size(); ++i)
+    {
+        EXPECT_EQ(all[i], pieces[i]) << i;
+    }
+}
+
+TEST(GaussianNoiseGeneratorTests, streams_and_seeds_differ)
+{
+    dbot::GaussianNoiseGenerator generator(1);
+
+    std::vector<double> a(16), b(16), c(16);
+    generator.fill(0, 0, a.size(), a.data());
+    generator.fill(1, 0, b.size(), b.data());
+    generator.seed(2);
+    generator.fill(0, 0, c.size(), c.data());
+
+    EXPECT_NE(a, b);
+    EXPECT_NE(a, c);
+}
+
+TEST(GaussianNoiseGeneratorTests, moments_are_standard_normal)
+{
+    dbot::GaussianNoiseGenerator generator(3);
+
+    const size_t count = 1000000;
+    std::vector<double> values(count);
+    generator.fill(0, 0, count, values.data());
+
+    double sum = 0, sum_squares = 0, sum_fourth = 0;
+    size_t within_one_sigma = 0;
+    for (double value : values)
+    {
+        ASSERT_TRUE(std::isfinite(value));
+        sum += value;
+        sum_squares += value * value;
+        sum_fourth += value * value * value * value;
+        within_one_sigma += std::fabs(value) < 1.;
+    }
+
+    EXPECT_NEAR(sum / count, 0., 5e-3);
+    EXPECT_NEAR(sum_squares / count, 1., 5e-3);
+    EXPECT_NEAR(sum_fourth / count, 3., 3e-2);
+    EXPECT_NEAR(within_one_sigma / double(count), 0.682689, 2e-3);
+}
@@ -0,0 +1,312 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file gl_context.cpp
+ * \date October 2016
+ */
+
+#include <GL/glew.h>
+#include <cstdio>
+#include <cstdlib>
+#include <dbot/gpu/gl_context.h>
+#include <vector>
+
+#if defined(DBOT_GL_CONTEXT_OSMESA)
+#include <GL/osmesa.h>
+#elif defined(DBOT_GL_CONTEXT_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#else
+#include <GL/glx.h>
+#define GL_CONTEXT_GLX
+#endif
+
+#if defined(DBOT_GL_CONTEXT_OSMESA)
+
+struct GLContext::Handles
+{
+    OSMesaContext context;
+
+    // OSMesa requires a client side color buffer for the default framebuffer
+    std::vector<GLubyte> buffer;
+};
+
+GLContext::GLContext(int nr_rows, int nr_cols) : handles_(new Handles)
+{
+    const int context_attribs[] = {OSMESA_FORMAT,
+                                   OSMESA_RGBA,
+                                   OSMESA_DEPTH_BITS,
+                                   0,
+                                   OSMESA_PROFILE,
+                                   OSMESA_CORE_PROFILE,
+                                   OSMESA_CONTEXT_MAJOR_VERSION,
+                                   3,
+                                   OSMESA_CONTEXT_MINOR_VERSION,
+                                   2,
+                                   0};
+
+    if (!(handles_->context = OSMesaCreateContextAttribs(context_attribs, 0)))
+    {
+        fprintf(stderr, "Failed to create OSMesa context\n");
+        exit(1);
+    }
+
+    handles_->buffer.resize(4 * nr_rows * nr_cols);
+    if (!OSMesaMakeCurrent(handles_->context,
+                           handles_->buffer.data(),
+                           GL_UNSIGNED_BYTE,
+                           nr_cols,
+                           nr_rows))
+    {
+        fprintf(stderr, "failed to make current\n");
+        exit(1);
+    }
+
+    init_glew();
+}
+
+GLContext::~GLContext()
+{
+    OSMesaDestroyContext(handles_->context);
+}
+
+const char* GLContext::backend_name()
+{
+    return "osmesa";
+}
+
+#elif defined(DBOT_GL_CONTEXT_EGL)
+
+struct GLContext::Handles
+{
+    EGLDisplay display;
+    EGLContext context;
+};
+
+GLContext::GLContext(int nr_rows, int nr_cols) : handles_(new Handles)
+{
+    /* prefer the surfaceless platform, it needs neither a display server nor
+     * a DRM device */
+    PFNEGLGETPLATFORMDISPLAYEXTPROC eglGetPlatformDisplayEXT =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress(
+            "eglGetPlatformDisplayEXT");
+
+    handles_->display = EGL_NO_DISPLAY;
+    if (eglGetPlatformDisplayEXT)
+    {
+        handles_->display = eglGetPlatformDisplayEXT(
+            EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, 0);
+    }
+    if (handles_->display == EGL_NO_DISPLAY)
+    {
+        handles_->display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    if (!eglInitialize(handles_->display, 0, 0))
+    {
+        fprintf(stderr, "Failed to initialize EGL display\n");
+        exit(1);
+    }
+
+    /* get framebuffer configs, any is usable since rendering goes to FBOs.
+     * The surfaceless platform offers pbuffer configs only. */
+    const EGLint config_attribs[] = {EGL_SURFACE_TYPE,
+                                     EGL_PBUFFER_BIT,
+                                     EGL_RENDERABLE_TYPE,
+                                     EGL_OPENGL_BIT,
+                                     EGL_NONE};
+    EGLConfig config;
+    EGLint config_count = 0;
+    if (!eglChooseConfig(
+            handles_->display, config_attribs, &config, 1, &config_count) ||
+        config_count == 0)
+    {
+        fprintf(stderr, "Failed to get EGLConfig\n");
+        exit(1);
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        fprintf(stderr, "missing support for desktop OpenGL in EGL\n");
+        exit(1);
+    }
+
+    const EGLint context_attribs[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                      3,
+                                      EGL_CONTEXT_MINOR_VERSION,
+                                      2,
+                                      EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                      EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                      EGL_NONE};
+    if ((handles_->context = eglCreateContext(handles_->display,
+                                              config,
+                                              EGL_NO_CONTEXT,
+                                              context_attribs)) ==
+        EGL_NO_CONTEXT)
+    {
+        fprintf(stderr, "Failed to create opengl context\n");
+        exit(1);
+    }
+
+    /* requires EGL_KHR_surfaceless_context */
+    if (!eglMakeCurrent(handles_->display,
+                        EGL_NO_SURFACE,
+                        EGL_NO_SURFACE,
+                        handles_->context))
+    {
+        fprintf(stderr, "failed to make current\n");
+        exit(1);
+    }
+
+    init_glew();
+}
+
+GLContext::~GLContext()
+{
+    eglMakeCurrent(
+        handles_->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(handles_->display, handles_->context);
+    eglTerminate(handles_->display);
+}
+
+const char* GLContext::backend_name()
+{
+    return "egl";
+}
+
+#else
+
+struct GLContext::Handles
+{
+    Display* display;
+    GLXContext context;
+};
+
+GLContext::GLContext(int nr_rows, int nr_cols) : handles_(new Handles)
+{
+    typedef GLXContext (*glXCreateContextAttribsARBProc)(
+        Display*, GLXFBConfig, GLXContext, Bool, const int*);
+    typedef Bool (*glXMakeContextCurrentARBProc)(
+        Display*, GLXDrawable, GLXDrawable, GLXContext);
+    static glXCreateContextAttribsARBProc glXCreateContextAttribsARB = 0;
+    static glXMakeContextCurrentARBProc glXMakeContextCurrentARB = 0;
+
+    static int visual_attribs[] = {None};
+    int context_attribs[] = {GLX_CONTEXT_MAJOR_VERSION_ARB,
+                             3,
+                             GLX_CONTEXT_MINOR_VERSION_ARB,
+                             2,
+                             None};
+
+    int fbcount = 0;
+    GLXFBConfig* fbc = NULL;
+    GLXPbuffer pbuf;
+    Display*& dpy = handles_->display;
+
+    /* open display */
+    if (!(dpy = XOpenDisplay(0)))
+    {
+        fprintf(stderr, "Failed to open display\n");
+        exit(1);
+    }
+
+    /* get framebuffer configs, any is usable (might want to add proper attribs)
+     */
+    if (!(fbc = glXChooseFBConfig(
+              dpy, DefaultScreen(dpy), visual_attribs, &fbcount)))
+    {
+        fprintf(stderr, "Failed to get FBConfig\n");
+        exit(1);
+    }
+
+    /* get the required extensions */
+    glXCreateContextAttribsARB =
+        (glXCreateContextAttribsARBProc)glXGetProcAddressARB(
+            (const GLubyte*)"glXCreateContextAttribsARB");
+    glXMakeContextCurrentARB =
+        (glXMakeContextCurrentARBProc)glXGetProcAddressARB(
+            (const GLubyte*)"glXMakeContextCurrent");
+    if (!(glXCreateContextAttribsARB && glXMakeContextCurrentARB))
+    {
+        fprintf(stderr, "missing support for GLX_ARB_create_context\n");
+        XFree(fbc);
+        exit(1);
+    }
+
+    /* create a context using glXCreateContextAttribsARB */
+    if (!(handles_->context = glXCreateContextAttribsARB(
+              dpy, fbc[0], 0, True, context_attribs)))
+    {
+        fprintf(stderr, "Failed to create opengl context\n");
+        XFree(fbc);
+        exit(1);
+    }
+
+    /* create temporary pbuffer */
+    int pbuffer_attribs[] = {
+        GLX_PBUFFER_WIDTH, nr_cols, GLX_PBUFFER_HEIGHT, nr_rows, None};
+    pbuf = glXCreatePbuffer(dpy, fbc[0], pbuffer_attribs);
+
+    XFree(fbc);
+    XSync(dpy, False);
+
+    /* try to make it the current context */
+    if (!glXMakeContextCurrent(dpy, pbuf, pbuf, handles_->context))
+    {
+        /* some drivers do not support context without default framebuffer, so
+         * fallback on
+         * using the default window.
+         */
+        if (!glXMakeContextCurrent(dpy,
+                                   DefaultRootWindow(dpy),
+                                   DefaultRootWindow(dpy),
+                                   handles_->context))
+        {
+            fprintf(stderr, "failed to make current\n");
+            exit(1);
+        }
+    }
+
+    init_glew();
+}
+
+GLContext::~GLContext()
+{
+    glXDestroyContext(handles_->display, handles_->context);
+}
+
+const char* GLContext::backend_name()
+{
+    return "glx";
+}
+
+#endif
+
+void GLContext::init_glew()
+{
+    glewExperimental = true;  // Needed for core profile
+    GLenum status = glewInit();
+
+#if !defined(GL_CONTEXT_GLX) && defined(GLEW_ERROR_NO_GLX_DISPLAY)
+    // a GLX build of GLEW loads all GL entry points before it fails on the
+    // missing GLX display of headless contexts
+    if (status == GLEW_ERROR_NO_GLX_DISPLAY) status = GLEW_OK;
+#endif
+
+    if (status != GLEW_OK)
+    {
+        fprintf(stderr, "Failed to initialize GLEW\n");
+        exit(EXIT_FAILURE);
+    }
+}
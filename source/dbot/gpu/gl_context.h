@@ -0,0 +1,69 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file gl_context.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <memory>
+
+/**
+ * \brief Windowless OpenGL 3.2 core profile context used by the
+ * ObjectRasterizer.
+ *
+ * The backend is selected at compile time through the DBOT_GL_CONTEXT cmake
+ * option:
+ *  - GLX (default) creates a pbuffer context on the X display and requires a
+ *    running X server.
+ *  - OSMESA (DBOT_GL_CONTEXT_OSMESA) creates an off-screen Mesa context which
+ *    renders in software, e.g. with llvmpipe.
+ *  - EGL (DBOT_GL_CONTEXT_EGL) creates a surfaceless context through
+ *    EGL_MESA_platform_surfaceless. It runs on llvmpipe as well as on GPUs
+ *    without a display.
+ *
+ * The ObjectRasterizer renders into its own framebuffer object only, hence
+ * none of the backends needs more than a minimal default framebuffer.
+ * Creating the context also makes it current and initializes GLEW. Failures
+ * are fatal.
+ */
+class GLContext
+{
+public:
+    /**
+     * \brief Creates the context and makes it current
+     * \param [in]  nr_rows height of the default framebuffer, if any
+     * \param [in]  nr_cols width of the default framebuffer, if any
+     */
+    GLContext(int nr_rows, int nr_cols);
+
+    /** destroys the context */
+    ~GLContext();
+
+    /**
+     * \brief Name of the backend compiled in (glx, osmesa or egl)
+     */
+    static const char* backend_name();
+
+    GLContext(const GLContext&) = delete;
+    GLContext& operator=(const GLContext&) = delete;
+
+private:
+    void init_glew();
+
+    /** backend specific handles, defined in gl_context.cpp */
+    struct Handles;
+    std::unique_ptr<Handles> handles_;
+};
@@ -19,7 +19,7 @@
 
 #include <Eigen/Geometry>  // there is a clash with Success enum and in X.h
 #include <GL/glew.h>
-#include <GL/glx.h>
+#include <algorithm>
 #include <dbot/gpu/object_rasterizer.h>
 #include <dbot/gpu/shader.h>
 #include <dbot/helper_functions.h>
@@ -45,101 +45,15 @@ ObjectRasterizer::ObjectRasterizer(
 {
     // ========== CREATE WINDOWLESS OPENGL CONTEXT =========== //
 
-    typedef GLXContext (*glXCreateContextAttribsARBProc)(
-        Display*, GLXFBConfig, GLXContext, Bool, const int*);
-    typedef Bool (*glXMakeContextCurrentARBProc)(
-        Display*, GLXDrawable, GLXDrawable, GLXContext);
-    static glXCreateContextAttribsARBProc glXCreateContextAttribsARB = 0;
-    static glXMakeContextCurrentARBProc glXMakeContextCurrentARB = 0;
-
-    static int visual_attribs[] = {None};
-    int context_attribs[] = {GLX_CONTEXT_MAJOR_VERSION_ARB,
-                             3,
-                             GLX_CONTEXT_MINOR_VERSION_ARB,
-                             2,
-                             None};
-
-    int fbcount = 0;
-    GLXFBConfig* fbc = NULL;
-    GLXPbuffer pbuf;
-
-    /* open display */
-    if (!(dpy_ = XOpenDisplay(0)))
-    {
-        fprintf(stderr, "Failed to open display\n");
-        exit(1);
-    }
-
-    /* get framebuffer configs, any is usable (might want to add proper attribs)
-     */
-    if (!(fbc = glXChooseFBConfig(
-              dpy_, DefaultScreen(dpy_), visual_attribs, &fbcount)))
-    {
-        fprintf(stderr, "Failed to get FBConfig\n");
-        exit(1);
-    }
-
-    /* get the required extensions */
-    glXCreateContextAttribsARB =
-        (glXCreateContextAttribsARBProc)glXGetProcAddressARB(
-            (const GLubyte*)"glXCreateContextAttribsARB");
-    glXMakeContextCurrentARB =
-        (glXMakeContextCurrentARBProc)glXGetProcAddressARB(
-            (const GLubyte*)"glXMakeContextCurrent");
-    if (!(glXCreateContextAttribsARB && glXMakeContextCurrentARB))
-    {
-        fprintf(stderr, "missing support for GLX_ARB_create_context\n");
-        XFree(fbc);
-        exit(1);
-    }
-
-    /* create a context using glXCreateContextAttribsARB */
-    if (!(ctx_ = glXCreateContextAttribsARB(
-              dpy_, fbc[0], 0, True, context_attribs)))
-    {
-        fprintf(stderr, "Failed to create opengl context\n");
-        XFree(fbc);
-        exit(1);
-    }
-
-    /* create temporary pbuffer */
-    int pbuffer_attribs[] = {
-        GLX_PBUFFER_WIDTH, nr_cols_, GLX_PBUFFER_HEIGHT, nr_rows_, None};
-    pbuf = glXCreatePbuffer(dpy_, fbc[0], pbuffer_attribs);
-
-    XFree(fbc);
-    XSync(dpy_, False);
-
-    /* try to make it the current context */
-    if (!glXMakeContextCurrent(dpy_, pbuf, pbuf, ctx_))
-    {
-        /* some drivers do not support context without default framebuffer, so
-         * fallback on
-         * using the default window.
-         */
-        if (!glXMakeContextCurrent(
-                dpy_, DefaultRootWindow(dpy_), DefaultRootWindow(dpy_), ctx_))
-        {
-            fprintf(stderr, "failed to make current\n");
-            exit(1);
-        }
-    }
+    context_.reset(new GLContext(nr_rows_, nr_cols_));
 
     /* try it out */
-    printf("vendor: %s\n", (const char*)glGetString(GL_VENDOR));
+    printf("vendor: %s, context: %s\n",
+           (const char*)glGetString(GL_VENDOR),
+           GLContext::backend_name());
 
     check_GL_errors("init windowsless context");
 
-    // Initialize GLEW
-
-    glewExperimental = true;  // Needed for core profile
-    if (glewInit() != GLEW_OK)
-    {
-        fprintf(stderr, "Failed to initialize GLEW\n");
-        exit(EXIT_FAILURE);
-    }
-    check_GL_errors("GLEW init");
-
     // ======================== SET OPENGL OPTIONS ======================== //
 
     // Enable depth test
@@ -461,6 +375,42 @@ void ObjectRasterizer::allocate_textures_for_max_poses(int nr_poses,
     reallocate_buffers();
 }
 
+void ObjectRasterizer::allocate_textures_for_max_poses(int nr_poses)
+{
+    int nr_poses_per_row, nr_poses_per_col;
+    compute_grid_layout(max_texture_size_,
+                        max_texture_size_,
+                        nr_rows_,
+                        nr_cols_,
+                        nr_poses,
+                        nr_poses_per_row,
+                        nr_poses_per_col);
+
+    if (nr_poses > nr_poses_per_row * nr_poses_per_col)
+    {
+        std::cout << "ERROR (OPENGL): Exceeding maximum texture size with "
+                  << nr_poses << " poses" << std::endl;
+        exit(-1);
+    }
+
+    allocate_textures_for_max_poses(
+        nr_poses, nr_poses_per_row, nr_poses_per_col);
+}
+
+void ObjectRasterizer::compute_grid_layout(int max_texture_size_x,
+                                           int max_texture_size_y,
+                                           int nr_rows,
+                                           int nr_cols,
+                                           int nr_poses,
+                                           int& nr_poses_per_row,
+                                           int& nr_poses_per_col)
+{
+    nr_poses_per_row = max_texture_size_x / nr_cols;
+    nr_poses_per_col =
+        std::min(max_texture_size_y / nr_rows,
+                 int(ceil(nr_poses / (float)nr_poses_per_row)));
+}
+
 GLuint ObjectRasterizer::get_framebuffer_texture()
 {
     return framebuffer_texture_for_all_poses_;
@@ -475,6 +425,9 @@ vector<vector<float>> ObjectRasterizer::get_depth_values(int nr_poses)
         exit(-1);
     }
 
+    vector<vector<float>> depth_image_per_pose(
+        nr_poses, vector<float>(nr_rows_ * nr_cols_, 0));
+
     // ===================== ATTACH TEXTURE TO FRAMEBUFFER ================ //
 
     glFramebufferTexture2D(GL_FRAMEBUFFER,  // 1. fbo target: GL_FRAMEBUFFER
@@ -486,79 +439,46 @@ vector<vector<float>> ObjectRasterizer::get_depth_values(int nr_poses)
     // ===================== TRANSFER DEPTH VALUES FROM GPU TO CPU == SLOW!!!
     // ================ //
 
+    // render() places the rows of the pose grid top down into the lowest
+    // nr_poses_per_col * nr_rows_ rows of the texture. Only these are read.
+    int nr_poses_per_col = ceil(nr_poses_ / (float)max_nr_poses_per_row_);
+    int pixels_per_row = max_nr_poses_per_row_ * nr_cols_;
+    int pixels_per_col = nr_poses_per_col * nr_rows_;
+
     glBindBuffer(GL_PIXEL_PACK_BUFFER, result_buffer_);
-    glBindTexture(GL_TEXTURE_2D, framebuffer_texture_for_all_poses_);
-    glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_FLOAT, 0);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glReadPixels(0, 0, pixels_per_row, pixels_per_col, GL_RED, GL_FLOAT, 0);
 
     GLfloat* pixel_depth =
         (GLfloat*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
 
     if (pixel_depth != (GLfloat*)NULL)
     {
-        int current_nr_poses_per_col = (nr_poses / max_nr_poses_per_row_) + 1;
-        int total_nr_pixels = nr_rows_ * nr_cols_ * max_nr_poses_per_row_ *
-                              current_nr_poses_per_col;
-        vector<float> depth_image(total_nr_pixels,
-                                  numeric_limits<float>::max());
-
-        int pixels_per_row = max_nr_poses_per_row_ * nr_cols_;
-        int pixels_per_col = current_nr_poses_per_col * nr_rows_;
         int highest_pixel_per_col = pixels_per_col - 1;
 
-        // reading OpenGL texture into an array on the CPU (inverted rows)
-        for (int row = 0; row < pixels_per_col; row++)
+        // copy each pose directly from the texture (inverted rows)
+        for (int pose_nr = 0; pose_nr < nr_poses; pose_nr++)
         {
-            int inverted_row = highest_pixel_per_col - row;
+            int pose_y = pose_nr / max_nr_poses_per_row_;
+            int pose_x = pose_nr % max_nr_poses_per_row_;
 
-            for (int col = 0; (col < pixels_per_row) &&
-                              (row * pixels_per_row + col < total_nr_pixels);
-                 col++)
+            for (int local_pixel_row = 0; local_pixel_row < nr_rows_;
+                 local_pixel_row++)
             {
-                int pixel_index = row * pixels_per_row + col;
-
-                depth_image[pixel_index] =
-                    pixel_depth[inverted_row * pixels_per_row + col];
+                int global_pixel_row = pose_y * nr_rows_ + local_pixel_row;
+                int inverted_row = highest_pixel_per_col - global_pixel_row;
+                const GLfloat* begin = pixel_depth +
+                                       inverted_row * pixels_per_row +
+                                       pose_x * nr_cols_;
+
+                std::copy(begin,
+                          begin + nr_cols_,
+                          depth_image_per_pose[pose_nr].begin() +
+                              local_pixel_row * nr_cols_);
             }
         }
 
         glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
-
-        // subdividing this array into an array per pose
-        vector<vector<float>> depth_image_per_pose(
-            nr_poses, vector<float>(nr_rows_ * nr_cols_, 0));
-
-        for (int pose_y = 0; pose_y < max_nr_poses_per_column_; pose_y++)
-        {
-            for (int pose_x = 0;
-                 pose_x < max_nr_poses_per_row_ &&
-                 pose_y * max_nr_poses_per_row_ + pose_x < nr_poses;
-                 pose_x++)
-            {
-                for (int local_pixel_row = 0; local_pixel_row < nr_rows_;
-                     local_pixel_row++)
-                {
-                    for (int local_pixel_col = 0; local_pixel_col < nr_cols_;
-                         local_pixel_col++)
-                    {
-                        int local_pixel_nr =
-                            local_pixel_row * nr_cols_ + local_pixel_col;
-                        int global_pixel_row =
-                            pose_y * nr_rows_ + local_pixel_row;
-                        int global_pixel_col =
-                            pose_x * nr_cols_ + local_pixel_col;
-                        int global_pixel_nr =
-                            global_pixel_row * pixels_per_row +
-                            global_pixel_col;
-                        int pose_nr = pose_y * max_nr_poses_per_row_ + pose_x;
-
-                        depth_image_per_pose[pose_nr][local_pixel_nr] =
-                            depth_image[global_pixel_nr];
-                    }
-                }
-            }
-        }
-
-        return depth_image_per_pose;
     }
     else
     {
@@ -578,6 +498,8 @@ vector<vector<float>> ObjectRasterizer::get_depth_values(int nr_poses)
 #ifdef DEBUG
     check_GL_errors("copying depth values to CPU");
 #endif
+
+    return depth_image_per_pose;
 }
 
 int ObjectRasterizer::get_max_texture_size()
@@ -875,5 +797,4 @@ ObjectRasterizer::~ObjectRasterizer()
     glDeleteRenderbuffers(1, &texture_for_z_testing);
 
     glDeleteProgram(shader_ID_);
-    glXDestroyContext(dpy_, ctx_);
 }
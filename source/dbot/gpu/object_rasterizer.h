@@ -21,7 +21,7 @@
 
 #include <Eigen/Dense>
 #include <GL/glew.h>
-#include <GL/glx.h>
+#include <dbot/gpu/gl_context.h>
 #include <dbot/gpu/shader_provider.h>
 #include <memory>
 #include <vector>
@@ -147,6 +147,35 @@ public:
                                          int nr_poses_per_row,
                                          int nr_poses_per_col);
 
+    /**
+     * \brief allocates memory for \a nr_poses poses in the grid layout given
+     * by compute_grid_layout() for the maximum texture size of OpenGL.
+     * Use this function if the rasterizer is used without a
+     * BufferConfiguration, e.g. with a headless context.
+     * \param[in] nr_poses number of poses for which space should be allocated.
+     */
+    void allocate_textures_for_max_poses(int nr_poses);
+
+    /**
+     * \brief computes the layout of the pose grid within the texture. Poses are
+     * placed row by row, each row containing as many poses as fit into the
+     * maximum texture width.
+     * \param [in]  max_texture_size_x maximum width of the texture
+     * \param [in]  max_texture_size_y maximum height of the texture
+     * \param [in]  nr_rows the vertical resolution per pose rendering
+     * \param [in]  nr_cols the horizontal resolution per pose rendering
+     * \param [in]  nr_poses the number of poses
+     * \param [out] nr_poses_per_row the number of poses per texture row
+     * \param [out] nr_poses_per_col the number of poses per texture column
+     */
+    static void compute_grid_layout(int max_texture_size_x,
+                                    int max_texture_size_y,
+                                    int nr_rows,
+                                    int nr_cols,
+                                    int nr_poses,
+                                    int& nr_poses_per_row,
+                                    int& nr_poses_per_col);
+
     /**
      * \brief returns the OpenGL framebuffer texture ID, which is needed for
      * CUDA interoperation.
@@ -187,9 +216,8 @@ public:
     int get_max_texture_size();
 
 private:
-    // OpenGL context variables
-    Display* dpy_;
-    GLXContext ctx_;
+    // OpenGL context, the backend is selected at compile time
+    std::unique_ptr<GLContext> context_;
 
     // GPU constraints
     GLint max_texture_size_;
@@ -0,0 +1,180 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file object_rasterizer_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <dbot/default_shader_provider.h>
+#include <dbot/gpu/object_rasterizer.h>
+#include <dbot/rigid_body_renderer.h>
+
+namespace
+{
+const int nr_rows = 60;
+const int nr_cols = 80;
+
+/**
+ * Box of two parts with different extents
+ */
+void boxes(std::vector<std::vector<Eigen::Vector3d>>& vertices,
+           std::vector<std::vector<std::vector<int>>>& indices)
+{
+    vertices.resize(2);
+    indices.resize(2);
+    for (int k = 0; k < 2; ++k)
+    {
+        double s = 0.04 + 0.02 * k;
+        for (int i = 0; i < 8; ++i)
+        {
+            vertices[k].push_back(Eigen::Vector3d(
+                i & 1 ? s : -s, i & 2 ? s : -s, i & 4 ? s : -s));
+        }
+        indices[k] = {{0, 2, 1},
+                      {1, 2, 3},
+                      {4, 5, 6},
+                      {5, 7, 6},
+                      {0, 1, 4},
+                      {1, 5, 4},
+                      {2, 6, 3},
+                      {3, 6, 7},
+                      {0, 4, 2},
+                      {2, 4, 6},
+                      {1, 3, 5},
+                      {3, 7, 5}};
+    }
+}
+
+Eigen::Matrix3d camera_matrix()
+{
+    Eigen::Matrix3d camera_matrix;
+    camera_matrix << 130., 0., 39.5, 0., 130., 29.5, 0., 0., 1.;
+    return camera_matrix;
+}
+
+Eigen::Affine3d pose(int i, int k)
+{
+    Eigen::Affine3d pose;
+    pose.setIdentity();
+    pose.translate(Eigen::Vector3d(0.06 * k - 0.03 + 0.01 * i,
+                                   0.005 * i - 0.02,
+                                   0.6 + 0.02 * i + 0.05 * k));
+    pose.rotate(Eigen::AngleAxisd(0.3 * i + k,
+                                  Eigen::Vector3d(3, 1, 2).normalized()));
+    return pose;
+}
+
+/**
+ * Renders \a nr_poses poses with the OpenGL rasterizer in a grid of
+ * \a nr_poses_per_row poses per row and compares each read back depth image
+ * with the CPU renderer. Pixels on silhouettes and on the boundaries between
+ * parts may be assigned differently.
+ */
+void expect_equal_to_cpu_rendering(ObjectRasterizer& rasterizer,
+                                   int nr_poses,
+                                   int nr_poses_per_row)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices;
+    std::vector<std::vector<std::vector<int>>> indices;
+    boxes(vertices, indices);
+    dbot::RigidBodyRenderer renderer(vertices, indices);
+
+    std::vector<std::vector<Eigen::Matrix4f>> states(nr_poses);
+    for (int i = 0; i < nr_poses; ++i)
+    {
+        for (int k = 0; k < 2; ++k)
+        {
+            states[i].push_back(pose(i, k).matrix().cast<float>());
+        }
+    }
+
+    int nr_poses_per_col = std::ceil(nr_poses / float(nr_poses_per_row));
+    rasterizer.allocate_textures_for_max_poses(
+        nr_poses, nr_poses_per_row, nr_poses_per_col);
+
+    std::vector<std::vector<float>> depth_values;
+    rasterizer.render(states, depth_values);
+    ASSERT_EQ(depth_values.size(), size_t(nr_poses));
+
+    for (int i = 0; i < nr_poses; ++i)
+    {
+        std::vector<float> cpu_depth;
+        renderer.set_poses({pose(i, 0), pose(i, 1)});
+        renderer.Render(camera_matrix(), nr_rows, nr_cols, cpu_depth);
+
+        int covered = 0;
+        int mismatches = 0;
+        for (int j = 0; j < nr_rows * nr_cols; ++j)
+        {
+            bool cpu_hit = std::isfinite(cpu_depth[j]);
+            bool gl_hit = depth_values[i][j] > 0;
+            covered += cpu_hit;
+
+            if (cpu_hit != gl_hit ||
+                (cpu_hit && std::fabs(cpu_depth[j] - depth_values[i][j]) >
+                                1e-3))
+            {
+                mismatches++;
+            }
+        }
+
+        EXPECT_GT(covered, 100);
+        EXPECT_LE(mismatches, covered / 10) << "pose " << i;
+    }
+}
+}
+
+class ObjectRasterizerTests : public ::testing::Test
+{
+protected:
+    void SetUp()
+    {
+        std::vector<std::vector<Eigen::Vector3d>> vertices;
+        std::vector<std::vector<std::vector<int>>> indices;
+        boxes(vertices, indices);
+
+        std::vector<std::vector<Eigen::Vector3f>> vertices_f(vertices.size());
+        for (size_t k = 0; k < vertices.size(); ++k)
+        {
+            for (auto& v : vertices[k])
+            {
+                vertices_f[k].push_back(v.cast<float>());
+            }
+        }
+
+        rasterizer_.reset(new ObjectRasterizer(
+            vertices_f,
+            indices,
+            std::make_shared<dbot::DefaultShaderProvider>(),
+            camera_matrix().cast<float>(),
+            nr_rows,
+            nr_cols));
+    }
+
+    std::unique_ptr<ObjectRasterizer> rasterizer_;
+};
+
+TEST_F(ObjectRasterizerTests, read_back_matches_cpu_rendering)
+{
+    expect_equal_to_cpu_rendering(*rasterizer_, 7, 3);
+}
+
+TEST_F(ObjectRasterizerTests, read_back_of_full_pose_grid)
+{
+    expect_equal_to_cpu_rendering(*rasterizer_, 6, 3);
+}
@@ -0,0 +1,475 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file mesh_simplification.cpp
+ * \date October 2016
+ */
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <queue>
+#include <utility>
+
+#include <Eigen/StdVector>
+
+#include <dbot/mesh_simplification.h>
+
+namespace dbot
+{
+namespace
+{
+typedef Eigen::Matrix4d Quadric;
+typedef std::array<int, 3> Triangle;
+
+/**
+ * \internal
+ * Collapses with a smaller quality would create sliver triangles, whose
+ * normals are sensitive to rounding errors
+ */
+const double min_triangle_quality = 1e-3;
+
+/**
+ * \internal
+ * Collapses which rotate a triangle normal by more than about 78 degrees are
+ * treated as flips
+ */
+const double min_normal_cosine = 0.2;
+
+/**
+ * \internal
+ * Weight of the planes perpendicular to boundary edges relative to the
+ * triangle planes
+ */
+const double boundary_weight = 1000.;
+
+/**
+ * \internal
+ * Candidate edge collapse. Candidates are invalidated lazily by comparing the
+ * versions of the end points.
+ */
+struct Collapse
+{
+    double cost;
+    int keep;
+    int remove;
+    int keep_version;
+    int remove_version;
+    Eigen::Vector3d target;
+
+    bool operator>(const Collapse& other) const { return cost > other.cost; }
+};
+
+Quadric plane_quadric(const Eigen::Vector3d& normal,
+                      const Eigen::Vector3d& point,
+                      double weight)
+{
+    Eigen::Vector4d plane;
+    plane << normal, -normal.dot(point);
+    return weight * plane * plane.transpose();
+}
+
+double quadric_error(const Quadric& quadric, const Eigen::Vector3d& point)
+{
+    Eigen::Vector4d homogeneous;
+    homogeneous << point, 1.;
+    return homogeneous.dot(quadric * homogeneous);
+}
+
+/**
+ * \internal
+ * Twice the area over the squared longest edge. This is zero for degenerate
+ * triangles and sqrt(3) / 2 for equilateral ones.
+ */
+double triangle_quality(const Eigen::Vector3d& a,
+                        const Eigen::Vector3d& b,
+                        const Eigen::Vector3d& c)
+{
+    double longest = std::max({(b - a).squaredNorm(),
+                               (c - b).squaredNorm(),
+                               (a - c).squaredNorm()});
+    if (longest == 0.) return 0.;
+
+    return (b - a).cross(c - a).norm() / longest;
+}
+
+class EdgeCollapser
+{
+public:
+    EdgeCollapser(const std::vector<Eigen::Vector3d>& vertices,
+                  const std::vector<std::vector<int>>& indices);
+
+    void run(size_t target_triangle_count);
+
+    void result(std::vector<Eigen::Vector3d>& vertices,
+                std::vector<std::vector<int>>& indices) const;
+
+private:
+    void add_boundary_quadrics();
+    void push_collapse(int keep, int remove);
+    bool collapse(const Collapse& collapse);
+    bool valid_target(int vertex,
+                      int other,
+                      const Eigen::Vector3d& target) const;
+    void neighbors(int vertex, std::vector<int>& result) const;
+
+private:
+    std::vector<Eigen::Vector3d> positions_;
+    std::vector<Quadric, Eigen::aligned_allocator<Quadric>> quadrics_;
+    std::vector<int> versions_;
+    std::vector<bool> vertex_alive_;
+    std::vector<std::vector<int>> vertex_triangles_;
+
+    std::vector<Triangle> triangles_;
+    std::vector<bool> triangle_alive_;
+    size_t triangle_count_;
+
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>>
+        queue_;
+};
+
+EdgeCollapser::EdgeCollapser(const std::vector<Eigen::Vector3d>& vertices,
+                             const std::vector<std::vector<int>>& indices)
+    : positions_(vertices),
+      quadrics_(vertices.size(), Quadric::Zero()),
+      versions_(vertices.size(), 0),
+      vertex_alive_(vertices.size(), true),
+      vertex_triangles_(vertices.size())
+{
+    for (const std::vector<int>& index : indices)
+    {
+        if (index.size() != 3 || index[0] == index[1] ||
+            index[1] == index[2] || index[2] == index[0])
+        {
+            continue;
+        }
+
+        Triangle triangle = {{index[0], index[1], index[2]}};
+        const Eigen::Vector3d& a = positions_[triangle[0]];
+        Eigen::Vector3d normal =
+            (positions_[triangle[1]] - a).cross(positions_[triangle[2]] - a);
+        double double_area = normal.norm();
+
+        if (double_area > 0.)
+        {
+            Quadric quadric =
+                plane_quadric(normal / double_area, a, double_area / 2.);
+            for (int vertex : triangle) quadrics_[vertex] += quadric;
+        }
+
+        for (int vertex : triangle)
+        {
+            vertex_triangles_[vertex].push_back(triangles_.size());
+        }
+        triangles_.push_back(triangle);
+    }
+    triangle_alive_.assign(triangles_.size(), true);
+    triangle_count_ = triangles_.size();
+
+    add_boundary_quadrics();
+}
+
+void EdgeCollapser::add_boundary_quadrics()
+{
+    // count the triangles of each edge and queue all edges
+    std::map<std::pair<int, int>, std::pair<int, int>> edges;
+    for (size_t i = 0; i < triangles_.size(); ++i)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            int a = triangles_[i][k];
+            int b = triangles_[i][(k + 1) % 3];
+            auto& edge = edges[std::make_pair(std::min(a, b), std::max(a, b))];
+            edge.first++;
+            edge.second = i;
+        }
+    }
+
+    for (const auto& edge : edges)
+    {
+        int a = edge.first.first;
+        int b = edge.first.second;
+
+        if (edge.second.first == 1)
+        {
+            const Triangle& triangle = triangles_[edge.second.second];
+            Eigen::Vector3d normal =
+                (positions_[triangle[1]] - positions_[triangle[0]])
+                    .cross(positions_[triangle[2]] - positions_[triangle[0]]);
+            Eigen::Vector3d direction = positions_[b] - positions_[a];
+            Eigen::Vector3d boundary_normal = direction.cross(normal);
+
+            if (boundary_normal.norm() > 0.)
+            {
+                Quadric quadric =
+                    plane_quadric(boundary_normal.normalized(),
+                                  positions_[a],
+                                  boundary_weight * direction.squaredNorm());
+                quadrics_[a] += quadric;
+                quadrics_[b] += quadric;
+            }
+        }
+
+        push_collapse(a, b);
+    }
+}
+
+void EdgeCollapser::push_collapse(int keep, int remove)
+{
+    const Quadric quadric = quadrics_[keep] + quadrics_[remove];
+    const Eigen::Vector3d& p0 = positions_[keep];
+    const Eigen::Vector3d& p1 = positions_[remove];
+    const Eigen::Vector3d middle = (p0 + p1) / 2.;
+
+    Collapse collapse;
+    collapse.keep = keep;
+    collapse.remove = remove;
+    collapse.keep_version = versions_[keep];
+    collapse.remove_version = versions_[remove];
+
+    // optimal position, if the quadric is well conditioned and the minimum
+    // lies close to the edge
+    Eigen::FullPivLU<Eigen::Matrix3d> lu(quadric.topLeftCorner<3, 3>());
+    if (lu.isInvertible())
+    {
+        collapse.target = lu.solve(-quadric.topRightCorner<3, 1>());
+        if ((collapse.target - middle).norm() <= (p1 - p0).norm())
+        {
+            collapse.cost = quadric_error(quadric, collapse.target);
+            queue_.push(collapse);
+            return;
+        }
+    }
+
+    // otherwise the best of the end points and the middle
+    collapse.cost = std::numeric_limits<double>::infinity();
+    for (const Eigen::Vector3d& candidate : {p0, p1, middle})
+    {
+        double cost = quadric_error(quadric, candidate);
+        if (cost < collapse.cost)
+        {
+            collapse.cost = cost;
+            collapse.target = candidate;
+        }
+    }
+    queue_.push(collapse);
+}
+
+void EdgeCollapser::run(size_t target_triangle_count)
+{
+    while (triangle_count_ > target_triangle_count && !queue_.empty())
+    {
+        Collapse candidate = queue_.top();
+        queue_.pop();
+
+        if (!vertex_alive_[candidate.keep] ||
+            !vertex_alive_[candidate.remove] ||
+            versions_[candidate.keep] != candidate.keep_version ||
+            versions_[candidate.remove] != candidate.remove_version)
+        {
+            continue;
+        }
+
+        collapse(candidate);
+    }
+}
+
+bool EdgeCollapser::collapse(const Collapse& collapse)
+{
+    const int keep = collapse.keep;
+    const int remove = collapse.remove;
+
+    // link condition: the end points may only share the neighbors opposite
+    // to the collapsed edge, otherwise the mesh would become non-manifold
+    int shared_triangles = 0;
+    for (int t : vertex_triangles_[keep])
+    {
+        if (!triangle_alive_[t]) continue;
+        const Triangle& triangle = triangles_[t];
+        if (std::find(triangle.begin(), triangle.end(), remove) !=
+            triangle.end())
+        {
+            shared_triangles++;
+        }
+    }
+
+    std::vector<int> keep_neighbors, remove_neighbors, common;
+    neighbors(keep, keep_neighbors);
+    neighbors(remove, remove_neighbors);
+    std::set_intersection(keep_neighbors.begin(),
+                          keep_neighbors.end(),
+                          remove_neighbors.begin(),
+                          remove_neighbors.end(),
+                          std::back_inserter(common));
+
+    if (shared_triangles == 0 || int(common.size()) != shared_triangles)
+    {
+        return false;
+    }
+
+    if (!valid_target(keep, remove, collapse.target) ||
+        !valid_target(remove, keep, collapse.target))
+    {
+        return false;
+    }
+
+    // move the kept vertex and hand over the triangles of the removed one
+    positions_[keep] = collapse.target;
+    quadrics_[keep] += quadrics_[remove];
+
+    for (int t : vertex_triangles_[remove])
+    {
+        if (!triangle_alive_[t]) continue;
+
+        Triangle& triangle = triangles_[t];
+        if (std::find(triangle.begin(), triangle.end(), keep) !=
+            triangle.end())
+        {
+            triangle_alive_[t] = false;
+            triangle_count_--;
+            continue;
+        }
+
+        std::replace(triangle.begin(), triangle.end(), remove, keep);
+        vertex_triangles_[keep].push_back(t);
+    }
+
+    vertex_alive_[remove] = false;
+    vertex_triangles_[remove].clear();
+
+    std::vector<int>& keep_triangles = vertex_triangles_[keep];
+    keep_triangles.erase(std::remove_if(keep_triangles.begin(),
+                                        keep_triangles.end(),
+                                        [&](int t)
+                                        {
+                                            return !triangle_alive_[t];
+                                        }),
+                         keep_triangles.end());
+
+    // the errors of all edges of the kept vertex have changed
+    versions_[keep]++;
+    neighbors(keep, keep_neighbors);
+    for (int neighbor : keep_neighbors)
+    {
+        push_collapse(keep, neighbor);
+    }
+
+    return true;
+}
+
+bool EdgeCollapser::valid_target(int vertex,
+                                 int other,
+                                 const Eigen::Vector3d& target) const
+{
+    for (int t : vertex_triangles_[vertex])
+    {
+        if (!triangle_alive_[t]) continue;
+
+        const Triangle& triangle = triangles_[t];
+        if (std::find(triangle.begin(), triangle.end(), other) !=
+            triangle.end())
+        {
+            // removed by the collapse
+            continue;
+        }
+
+        Eigen::Vector3d before[3], after[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            before[k] = positions_[triangle[k]];
+            after[k] = triangle[k] == vertex ? target : before[k];
+        }
+
+        if (triangle_quality(after[0], after[1], after[2]) <
+            min_triangle_quality)
+        {
+            return false;
+        }
+
+        Eigen::Vector3d normal_before =
+            (before[1] - before[0]).cross(before[2] - before[0]);
+        Eigen::Vector3d normal_after =
+            (after[1] - after[0]).cross(after[2] - after[0]);
+        if (normal_before.normalized().dot(normal_after.normalized()) <
+            min_normal_cosine)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void EdgeCollapser::neighbors(int vertex, std::vector<int>& result) const
+{
+    result.clear();
+    for (int t : vertex_triangles_[vertex])
+    {
+        if (!triangle_alive_[t]) continue;
+        for (int neighbor : triangles_[t])
+        {
+            if (neighbor != vertex) result.push_back(neighbor);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+void EdgeCollapser::result(std::vector<Eigen::Vector3d>& vertices,
+                           std::vector<std::vector<int>>& indices) const
+{
+    vertices.clear();
+    indices.clear();
+
+    // keep the used vertices in their original order
+    std::vector<int> new_index(positions_.size(), -1);
+    for (size_t t = 0; t < triangles_.size(); ++t)
+    {
+        if (!triangle_alive_[t]) continue;
+        for (int vertex : triangles_[t]) new_index[vertex] = 0;
+    }
+
+    for (size_t vertex = 0; vertex < positions_.size(); ++vertex)
+    {
+        if (new_index[vertex] < 0) continue;
+        new_index[vertex] = vertices.size();
+        vertices.push_back(positions_[vertex]);
+    }
+
+    for (size_t t = 0; t < triangles_.size(); ++t)
+    {
+        if (!triangle_alive_[t]) continue;
+
+        const Triangle& triangle = triangles_[t];
+        indices.push_back({new_index[triangle[0]],
+                           new_index[triangle[1]],
+                           new_index[triangle[2]]});
+    }
+}
+}
+
+void simplify_mesh(const std::vector<Eigen::Vector3d>& vertices,
+                   const std::vector<std::vector<int>>& indices,
+                   size_t target_triangle_count,
+                   std::vector<Eigen::Vector3d>& simplified_vertices,
+                   std::vector<std::vector<int>>& simplified_indices)
+{
+    EdgeCollapser collapser(vertices, indices);
+    collapser.run(target_triangle_count);
+    collapser.result(simplified_vertices, simplified_indices);
+}
+}
@@ -0,0 +1,44 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file mesh_simplification.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace dbot
+{
+/**
+ * \brief Reduces a triangle mesh to at most \a target_triangle_count triangles
+ *        by quadric error edge collapses (Garland and Heckbert, 1997)
+ *
+ * Each vertex accumulates the squared distances to the planes of its
+ * triangles. Edges are collapsed to the point minimizing the summed quadric
+ * of both end points in the order of increasing error. Collapses which would
+ * flip or degenerate a triangle or make the mesh non-manifold are skipped,
+ * hence the target may not be reached for very small targets. Boundary edges
+ * are preserved by additional planes perpendicular to the boundary. The
+ * orientation of the triangles is kept.
+ */
+void simplify_mesh(const std::vector<Eigen::Vector3d>& vertices,
+                   const std::vector<std::vector<int>>& indices,
+                   size_t target_triangle_count,
+                   std::vector<Eigen::Vector3d>& simplified_vertices,
+                   std::vector<std::vector<int>>& simplified_indices);
+}
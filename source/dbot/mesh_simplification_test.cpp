@@ -0,0 +1,209 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file mesh_simplification_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <utility>
+
+#include <dbot/mesh_simplification.h>
+#include <dbot/object_model.h>
+#include <dbot/rigid_body_renderer.h>
+#include <dbot/simple_wavefront_object_loader.h>
+
+namespace
+{
+/**
+ * Unit sphere approximated by a subdivided icosahedron with outward facing
+ * triangles
+ */
+void icosphere(int subdivisions,
+               std::vector<Eigen::Vector3d>& vertices,
+               std::vector<std::vector<int>>& indices)
+{
+    const double t = (1. + std::sqrt(5.)) / 2.;
+    vertices = {{-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+                {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+                {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+    for (auto& vertex : vertices) vertex.normalize();
+
+    indices = {{0, 11, 5}, {0, 5, 1},  {0, 1, 7},   {0, 7, 10}, {0, 10, 11},
+               {1, 5, 9},  {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+               {3, 9, 4},  {3, 4, 2},  {3, 2, 6},   {3, 6, 8},  {3, 8, 9},
+               {4, 9, 5},  {2, 4, 11}, {6, 2, 10},  {8, 6, 7},  {9, 8, 1}};
+
+    for (int s = 0; s < subdivisions; ++s)
+    {
+        std::map<std::pair<int, int>, int> middles;
+        auto middle = [&](int a, int b)
+        {
+            auto key = std::make_pair(std::min(a, b), std::max(a, b));
+            auto entry = middles.find(key);
+            if (entry != middles.end()) return entry->second;
+
+            vertices.push_back((vertices[a] + vertices[b]).normalized());
+            middles[key] = vertices.size() - 1;
+            return int(vertices.size() - 1);
+        };
+
+        std::vector<std::vector<int>> subdivided;
+        for (const auto& triangle : indices)
+        {
+            int a = middle(triangle[0], triangle[1]);
+            int b = middle(triangle[1], triangle[2]);
+            int c = middle(triangle[2], triangle[0]);
+            subdivided.push_back({triangle[0], a, c});
+            subdivided.push_back({triangle[1], b, a});
+            subdivided.push_back({triangle[2], c, b});
+            subdivided.push_back({a, b, c});
+        }
+        indices = subdivided;
+    }
+}
+}
+
+TEST(MeshSimplificationTests, simplified_sphere_stays_closed_and_close)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<std::vector<int>> indices;
+    icosphere(4, vertices, indices);
+    ASSERT_EQ(indices.size(), 5120);
+
+    std::vector<Eigen::Vector3d> simplified_vertices;
+    std::vector<std::vector<int>> simplified_indices;
+    dbot::simplify_mesh(
+        vertices, indices, 500, simplified_vertices, simplified_indices);
+
+    EXPECT_LE(simplified_indices.size(), 500);
+    EXPECT_GT(simplified_indices.size(), 400);
+
+    for (const auto& vertex : simplified_vertices)
+    {
+        EXPECT_NEAR(vertex.norm(), 1., 0.05);
+    }
+
+    // every edge is shared by exactly two triangles with opposite directions
+    // and all triangles still face outward
+    std::map<std::pair<int, int>, int> directed_edges;
+    for (const auto& triangle : simplified_indices)
+    {
+        const Eigen::Vector3d& a = simplified_vertices[triangle[0]];
+        const Eigen::Vector3d& b = simplified_vertices[triangle[1]];
+        const Eigen::Vector3d& c = simplified_vertices[triangle[2]];
+        EXPECT_GT((b - a).cross(c - a).dot(a + b + c), 0.);
+
+        for (int k = 0; k < 3; ++k)
+        {
+            directed_edges[std::make_pair(triangle[k],
+                                          triangle[(k + 1) % 3])]++;
+        }
+    }
+
+    for (const auto& edge : directed_edges)
+    {
+        EXPECT_EQ(edge.second, 1);
+        EXPECT_EQ(directed_edges.count(
+                      std::make_pair(edge.first.second, edge.first.first)),
+                  1);
+    }
+}
+
+TEST(MeshSimplificationTests, keeps_mesh_below_target)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<std::vector<int>> indices;
+    icosphere(1, vertices, indices);
+
+    std::vector<Eigen::Vector3d> simplified_vertices;
+    std::vector<std::vector<int>> simplified_indices;
+    dbot::simplify_mesh(vertices,
+                        indices,
+                        indices.size(),
+                        simplified_vertices,
+                        simplified_indices);
+
+    EXPECT_EQ(simplified_vertices, vertices);
+    EXPECT_EQ(simplified_indices, indices);
+}
+
+TEST(MeshSimplificationTests, object_model_levels_load_into_renderer)
+{
+    // an uneven mesh in meters away from the origin, like a scanned object
+    std::vector<Eigen::Vector3d> vertices;
+    std::vector<std::vector<int>> indices;
+    icosphere(4, vertices, indices);
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        Eigen::Vector3d& vertex = vertices[i];
+        vertex *= 1. + 0.05 * std::sin(7. * vertex.x() + 3. * i);
+        vertex = Eigen::Vector3d(0.04 * vertex.x() + 0.3,
+                                 0.07 * vertex.y() - 0.2,
+                                 0.1 * vertex.z() + 0.9);
+    }
+
+    const std::string directory = testing::TempDir();
+    const std::string file = "mesh_simplification_test.obj";
+    {
+        std::ofstream obj(directory + "/" + file);
+        obj.precision(17);
+        for (const auto& vertex : vertices)
+        {
+            obj << "v " << vertex.x() << " " << vertex.y() << " "
+                << vertex.z() << "\n";
+        }
+        for (const auto& triangle : indices)
+        {
+            obj << "f " << triangle[0] + 1 << " " << triangle[1] + 1 << " "
+                << triangle[2] + 1 << "\n";
+        }
+    }
+
+    dbot::ObjectModel model(
+        std::make_shared<dbot::SimpleWavefrontObjectModelLoader>(
+            dbot::ObjectResourceIdentifier(directory, "", {file})),
+        true);
+    std::remove((directory + "/" + file).c_str());
+    model.generate_levels(7, 0.5);
+    ASSERT_EQ(model.count_levels(), 7);
+
+    dbot::RigidBodyRenderer::Affine pose =
+        dbot::RigidBodyRenderer::Affine::Identity();
+    pose.translation() = Eigen::Vector3d(0., 0., 0.8);
+
+    // the renderer aborts on triangles whose normal can not be computed
+    for (int level = 0; level < model.count_levels(); ++level)
+    {
+        ASSERT_GT(model.triangle_indices(level)[0].size(), 0);
+
+        dbot::RigidBodyRenderer renderer(model.vertices(level),
+                                         model.triangle_indices(level));
+        renderer.set_poses({pose});
+
+        std::vector<float> depth_image;
+        Eigen::Matrix3d camera_matrix;
+        camera_matrix << 525., 0., 319.5, 0., 525., 239.5, 0., 0., 1.;
+        renderer.Render(camera_matrix, 480, 640, depth_image);
+        EXPECT_LT(*std::min_element(depth_image.begin(), depth_image.end()),
+                  1.);
+    }
+}
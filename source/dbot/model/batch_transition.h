@@ -0,0 +1,57 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file batch_transition.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+
+namespace dbot
+{
+/**
+ * \brief Interface of transitions which propagate many states at once
+ *
+ * The states and noises are passed as matrices with one column per state.
+ * Particle filters use it in place of evaluating the transition function
+ * once per particle if their transition implements it.
+ */
+template <typename Input>
+class BatchTransition
+{
+public:
+    typedef typename Input::Scalar Scalar;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Matrix;
+
+public:
+    virtual ~BatchTransition() noexcept {}
+
+    /**
+     * \brief Propagates each column of \a prev_states with the noise in the
+     *        same column of \a noises
+     *
+     * \param [in]  prev_states  state dimension x count
+     * \param [in]  noises       noise dimension x count
+     * \param [in]  input        input shared by all states
+     * \param [out] states       state dimension x count, must not alias the
+     *                           arguments
+     */
+    virtual void states(const Eigen::Ref<const Matrix>& prev_states,
+                        const Eigen::Ref<const Matrix>& noises,
+                        const Input& input,
+                        Eigen::Ref<Matrix> states) const = 0;
+};
+}
@@ -0,0 +1,104 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file block_diagonal_linear_transition.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+
+#include <Eigen/Core>
+
+#include <fl/model/transition/linear_transition.hpp>
+
+#include <dbot/model/batch_transition.h>
+
+namespace dbot
+{
+/**
+ * \brief Linear transition whose dynamics and noise matrices are block
+ *        diagonal with equally sized blocks, e.g. one 12 x 12 dynamics and
+ *        one 12 x 6 noise block per object part
+ *
+ * Propagating a batch of states costs one small product per block instead
+ * of a dense product with the whole matrices, which are mostly zero for
+ * objects of many parts. The blocks are read from the matrices of the
+ * linear transition, entries outside of the blocks are ignored.
+ */
+template <typename State, typename Noise, typename Input>
+class BlockDiagonalLinearTransition
+    : public fl::LinearTransition<State, Noise, Input>,
+      public BatchTransition<Input>
+{
+public:
+    typedef fl::LinearTransition<State, Noise, Input> Base;
+    typedef typename BatchTransition<Input>::Matrix Matrix;
+
+public:
+    /**
+     * \param [in]  transition  linear transition of block diagonal dynamics
+     *                          and noise matrices
+     * \param [in]  block_count number of blocks on the diagonals
+     */
+    BlockDiagonalLinearTransition(const Base& transition, int block_count)
+        : Base(transition), block_count_(block_count)
+    {
+        if (block_count_ < 1 ||
+            this->state_dimension() % block_count_ != 0 ||
+            this->noise_dimension() % block_count_ != 0)
+        {
+            std::cout << "the state dimension " << this->state_dimension()
+                      << " and noise dimension " << this->noise_dimension()
+                      << " can not be split into " << block_count_
+                      << " blocks" << std::endl;
+            exit(-1);
+        }
+    }
+
+    void states(const Eigen::Ref<const Matrix>& prev_states,
+                const Eigen::Ref<const Matrix>& noises,
+                const Input& input,
+                Eigen::Ref<Matrix> states) const
+    {
+        const int state_size = this->state_dimension() / block_count_;
+        const int noise_size = this->noise_dimension() / block_count_;
+
+        for (int k = 0; k < block_count_; ++k)
+        {
+            const int row = k * state_size;
+            const int noise_row = k * noise_size;
+
+            states.middleRows(row, state_size).noalias() =
+                this->dynamics_matrix().block(
+                    row, row, state_size, state_size) *
+                prev_states.middleRows(row, state_size);
+            states.middleRows(row, state_size).noalias() +=
+                this->noise_matrix().block(
+                    row, noise_row, state_size, noise_size) *
+                noises.middleRows(noise_row, noise_size);
+        }
+
+        if (this->input_dimension() > 0)
+        {
+            states.colwise() += this->input_matrix() * input;
+        }
+    }
+
+private:
+    int block_count_;
+};
+}
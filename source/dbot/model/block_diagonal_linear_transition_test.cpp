@@ -0,0 +1,96 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file block_diagonal_linear_transition_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/model/block_diagonal_linear_transition.h>
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
+
+namespace
+{
+typedef dbot::FreeFloatingRigidBodiesState<> State;
+typedef Eigen::Matrix<fl::Real, -1, 1> Noise;
+typedef Eigen::Matrix<fl::Real, -1, 1> Input;
+typedef fl::LinearTransition<State, Noise, Input> Linear;
+typedef dbot::BlockDiagonalLinearTransition<State, Noise, Input> Batch;
+
+const int part_count = 3;
+
+Linear random_transition()
+{
+    Linear transition(part_count * 12, part_count * 6, 2);
+
+    auto A = transition.create_dynamics_matrix();
+    auto B = transition.create_noise_matrix();
+    A.setZero();
+    B.setZero();
+    for (int k = 0; k < part_count; ++k)
+    {
+        A.block(k * 12, k * 12, 12, 12).setRandom();
+        B.block(k * 12, k * 6, 12, 6).setRandom();
+    }
+    transition.dynamics_matrix(A);
+    transition.noise_matrix(B);
+    transition.input_matrix(transition.create_input_matrix().setRandom());
+
+    return transition;
+}
+}
+
+TEST(BlockDiagonalLinearTransitionTests, batch_matches_single_states)
+{
+    Batch transition(random_transition(), part_count);
+
+    const int count = 17;
+    Batch::Matrix prev_states = Batch::Matrix::Random(part_count * 12, count);
+    Batch::Matrix noises = Batch::Matrix::Random(part_count * 6, count);
+    Input input = Input::Random(2);
+
+    Batch::Matrix states(part_count * 12, count);
+    transition.states(prev_states, noises, input, states);
+
+    for (int i = 0; i < count; ++i)
+    {
+        State expected = transition.state(
+            State(prev_states.col(i)), Noise(noises.col(i)), input);
+
+        EXPECT_TRUE(states.col(i).isApprox(expected, 1e-12)) << i;
+    }
+}
+
+TEST(BlockDiagonalLinearTransitionTests, batch_of_column_range)
+{
+    Batch transition(random_transition(), part_count);
+
+    Batch::Matrix prev_states = Batch::Matrix::Random(part_count * 12, 10);
+    Batch::Matrix noises = Batch::Matrix::Random(part_count * 6, 10);
+    Input input = Input::Random(2);
+
+    Batch::Matrix all(part_count * 12, 10);
+    transition.states(prev_states, noises, input, all);
+
+    Batch::Matrix part = Batch::Matrix::Zero(part_count * 12, 10);
+    transition.states(prev_states.middleCols(3, 4),
+                      noises.middleCols(3, 4),
+                      input,
+                      part.middleCols(3, 4));
+
+    EXPECT_TRUE(part.middleCols(3, 4).isApprox(all.middleCols(3, 4)));
+    EXPECT_TRUE(part.leftCols(3).isZero());
+    EXPECT_TRUE(part.rightCols(3).isZero());
+}
@@ -135,27 +135,30 @@ private:
     void map(const State& pose, Eigen::VectorXd& obsrv_image) const
     {
         renderer_->set_poses({pose.component(0).affine()});
-        renderer_->Render(depth_rendering_);
-
-        convert(depth_rendering_, obsrv_image);
+        renderer_->Render(renderer_->camera_matrix_,
+                          renderer_->n_rows_,
+                          renderer_->n_cols_,
+                          render_context_,
+                          intersect_indices_,
+                          depth_rendering_);
+
+        convert(intersect_indices_,
+                depth_rendering_,
+                renderer_->n_rows_ * renderer_->n_cols_,
+                obsrv_image);
     }
 
-    void convert(const std::vector<float>& depth,
+    void convert(const std::vector<int>& intersect_indices,
+                 const std::vector<float>& depth,
+                 int pixel_count,
                  Eigen::VectorXd& obsrv_image) const
     {
-        const int pixel_count = depth.size();
-        obsrv_image.resize(pixel_count, 1);
+        obsrv_image.setConstant(
+            pixel_count, 1, std::numeric_limits<double>::infinity());
 
-        for (int i = 0; i < pixel_count; ++i)
+        for (size_t i = 0; i < intersect_indices.size(); ++i)
         {
-            if (!std::isinf(depth[i]))
-            {
-                obsrv_image(i, 0) = depth[i];
-            }
-            else
-            {
-                obsrv_image(i, 0) = std::numeric_limits<double>::infinity();
-            }
+            obsrv_image(intersect_indices[i], 0) = depth[i];
         }
     }
 
@@ -213,6 +216,8 @@ private:
     mutable Gaussian<Obsrv> bg_density_;
 
     mutable std::shared_ptr<std::mutex> mutex;
+    mutable dbot::RigidBodyRenderer::RenderContext render_context_;
+    mutable std::vector<int> intersect_indices_;
     mutable std::vector<float> depth_rendering_;
     std::shared_ptr<dbot::RigidBodyRenderer> renderer_;
 
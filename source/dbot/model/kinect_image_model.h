@@ -29,21 +29,33 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <dbot/depth_layer_cache.h>
+#include <dbot/model/kinect_pixel_kernel.h>
 #include <dbot/model/kinect_pixel_model.h>
 #include <dbot/model/occlusion_model.h>
+#include <dbot/model/occlusion_process.h>
+#include <dbot/model/occlusion_quantizer.h>
 #include <dbot/model/rao_blackwell_sensor.h>
 #include <dbot/pose/free_floating_rigid_bodies_state.h>
 #include <dbot/pose/pose_vector.h>
 #include <dbot/rigid_body_renderer.h>
 #include <dbot/traits.h>
 #include <fl/util/assertions.hpp>
+#include <algorithm>
 #include <memory>
+#include <stdexcept>
+#include <typeinfo>
+#include <unordered_map>
 #include <vector>
 
 namespace dbot
 {
 // Forward declarations
-template <typename Scalar, typename State, int OBJECTS>
+template <typename Scalar,
+          typename State,
+          int OBJECTS,
+          typename PixelPolicy,
+          typename OcclusionPolicy>
 class KinectImageModel;
 
 namespace internal
@@ -52,8 +64,13 @@ namespace internal
  * ImageSensorCPU distribution traits specialization
  * \internal
  */
-template <typename Scalar, typename State, int OBJECTS>
-struct Traits<KinectImageModel<Scalar, State, OBJECTS>>
+template <typename Scalar,
+          typename State,
+          int OBJECTS,
+          typename PixelPolicy,
+          typename OcclusionPolicy>
+struct Traits<
+    KinectImageModel<Scalar, State, OBJECTS, PixelPolicy, OcclusionPolicy>>
 {
     typedef RbSensor<State> SensorBase;
     typedef typename SensorBase::Observation Observation;
@@ -67,15 +84,36 @@ struct Traits<KinectImageModel<Scalar, State, OBJECTS>>
 /**
  * \class ImageSensorCPU
  *
+ * The pixel and occlusion models are stateless policies whose methods are
+ * called from all executor threads:
+ *
+ * - PixelPolicy provides
+ *   log_likelihood_ratios(predictions, observations, occlusions, count,
+ *   log_ratios, posteriors) const, see KinectPixelKernel
+ * - OcclusionPolicy provides predict(delta_time, occlusion) const returning
+ *   the predicted occlusion probability, see OcclusionProcess
+ *
  * \ingroup distributions
  * \ingroup sensors
  */
-template <typename Scalar, typename State, int OBJECTS = -1>
+template <typename Scalar,
+          typename State,
+          int OBJECTS = -1,
+          typename PixelPolicy = KinectPixelKernel,
+          typename OcclusionPolicy = OcclusionProcess>
 class KinectImageModel
-    : public internal::Traits<KinectImageModel<Scalar, State>>::SensorBase
+    : public internal::Traits<KinectImageModel<Scalar,
+                                               State,
+                                               OBJECTS,
+                                               PixelPolicy,
+                                               OcclusionPolicy>>::SensorBase
 {
 public:
-    typedef internal::Traits<KinectImageModel<Scalar, State>> Traits;
+    typedef internal::Traits<KinectImageModel<Scalar,
+                                              State,
+                                              OBJECTS,
+                                              PixelPolicy,
+                                              OcclusionPolicy>> Traits;
 
     typedef typename Traits::SensorBase Base;
     typedef typename Traits::Observation Observation;
@@ -94,18 +132,20 @@ public:
                      const size_t& n_rows,
                      const size_t& n_cols,
                      const ObjectRendererPtr object_renderer,
-                     const PixelSensorPtr sensor,
-                     const OcclusionModelPtr occlusion_transition,
+                     const PixelPolicy& pixel_model,
+                     const OcclusionPolicy& occlusion_model,
                      const float& initial_occlusion,
                      const double& delta_time)
         : camera_matrix_(camera_matrix),
           n_rows_(n_rows),
           n_cols_(n_cols),
-          initial_occlusion_(initial_occlusion),
+          initial_occlusion_(OcclusionQuantizer::decode(
+              OcclusionQuantizer::encode(initial_occlusion))),
           object_model_(object_renderer),
-          sensor_(sensor),
-          occlusion_transition_(occlusion_transition),
-          observation_time_(0),
+          pixel_model_(pixel_model),
+          occlusion_model_(occlusion_model),
+          frame_(0),
+          layer_cache_(object_renderer),
           Base(delta_time)
     {
         static_assert_base(State, dbot::RigidBodiesState<OBJECTS>);
@@ -113,30 +153,50 @@ public:
         this->default_poses_.recount(object_model_->vertices().size());
         this->default_poses_.setZero();
 
+        auto renderer_executor = object_model_->executor();
+        executor(renderer_executor ? renderer_executor
+                                   : std::make_shared<SerialExecutor>());
+
         reset();
     }
 
+    /**
+     * \brief Evaluates the given conditional models through their stateless
+     *        kernel and process
+     *
+     * \throws std::invalid_argument if a model is of a derived class, whose
+     *         overrides could not be evaluated concurrently
+     */
+    KinectImageModel(const Eigen::Matrix3d& camera_matrix,
+                     const size_t& n_rows,
+                     const size_t& n_cols,
+                     const ObjectRendererPtr object_renderer,
+                     const PixelSensorPtr sensor,
+                     const OcclusionModelPtr occlusion_transition,
+                     const float& initial_occlusion,
+                     const double& delta_time)
+        : KinectImageModel(camera_matrix,
+                           n_rows,
+                           n_cols,
+                           object_renderer,
+                           exact_model(sensor).kernel(),
+                           exact_model(occlusion_transition).process(),
+                           initial_occlusion,
+                           delta_time)
+    {
+    }
+
     virtual ~KinectImageModel() noexcept {}
     RealArray loglikes(const StateArray& deltas,
                        IntArray& indices,
                        const bool& update = false)
     {
-        std::vector<std::vector<float>> new_occlusions(deltas.size());
-        std::vector<std::vector<double>> new_occlusion_times(deltas.size());
-
-        RealArray log_likes = RealArray::Zero(deltas.size());
+        // render all particles, reusing the layers of unchanged parts --------
+        std::vector<std::vector<Affine>> poses(deltas.size());
         for (size_t i_state = 0; i_state < size_t(deltas.size()); i_state++)
         {
-            if (update)
-            {
-                new_occlusions[i_state] = occlusions_[indices[i_state]];
-                new_occlusion_times[i_state] =
-                    occlusion_times_[indices[i_state]];
-            }
-
-            // render the object model -----------------------------------------
             int body_count = deltas[i_state].count();
-            std::vector<Affine> poses(body_count);
+            poses[i_state].resize(body_count);
             for (size_t i_obj = 0; i_obj < body_count; i_obj++)
             {
                 auto pose_0 = this->default_poses_.component(i_obj);
@@ -151,79 +211,85 @@ public:
                     pose_0.position();
                 pose.orientation() = pose_0.orientation() * delta.orientation();
 
-                poses[i_obj] = pose.affine();
+                poses[i_state][i_obj] = pose.affine();
             }
-            object_model_->set_poses(poses);
-            std::vector<int> intersect_indices;
-            std::vector<float> predictions;
-            object_model_->Render(camera_matrix_,
-                                  n_rows_,
-                                  n_cols_,
-                                  intersect_indices,
-                                  predictions);
+        }
+        layer_cache_.render(poses, camera_matrix_, n_rows_, n_cols_);
+
+        // resampled particles share the occlusion maps of their parents and
+        // maps share the tiles they have not updated since they diverged. A
+        // particle updates its map in place if it is the only one referring
+        // to it and copies the list of tiles on its first update otherwise.
+        // Tiles are copied on their first update unless they are owned, i.e.
+        // referred to by a single exclusive map. Ownership is determined
+        // before the concurrent evaluation.
+        std::vector<OcclusionMapPtr> new_maps;
+        std::vector<char> exclusive;
+        std::vector<std::vector<char>> owned_tiles;
+        if (update)
+        {
+            extend_footprint(deltas.size());
 
-            // compute likelihoods ---------------------------------------------
-            for (size_t i = 0; i < size_t(predictions.size()); i++)
+            std::unordered_map<const OcclusionMap*, int> references;
+            for (size_t i_state = 0; i_state < indices.size(); i_state++)
             {
-                if (std::isnan(observations_[intersect_indices[i]]))
-                {
-                    log_likes[i_state] += log(1.);
-                }
-                else
+                references[occlusion_maps_[indices[i_state]].get()]++;
+            }
+
+            new_maps.resize(deltas.size());
+            exclusive.resize(deltas.size());
+            owned_tiles.resize(deltas.size());
+            for (size_t i_state = 0; i_state < indices.size(); i_state++)
+            {
+                new_maps[i_state] = occlusion_maps_[indices[i_state]];
+                exclusive[i_state] = references[new_maps[i_state].get()] == 1;
+                if (!exclusive[i_state]) continue;
+
+                const auto& tiles = new_maps[i_state]->tiles;
+                owned_tiles[i_state].resize(tiles.size());
+                for (size_t t = 0; t < tiles.size(); t++)
                 {
-                    double delta_time = observation_time_ -
-                                        occlusion_times_[indices[i_state]]
-                                                        [intersect_indices[i]];
-
-                    occlusion_transition_->Condition(
-                        delta_time,
-                        occlusions_[indices[i_state]][intersect_indices[i]]);
-
-                    float occlusion =
-                        occlusion_transition_->MapStandardGaussian();
-
-                    sensor_->Condition(predictions[i], false);
-                    float p_obsIpred_vis =
-                        sensor_->Probability(
-                            observations_[intersect_indices[i]]) *
-                        (1.0 - occlusion);
-
-                    sensor_->Condition(predictions[i], true);
-                    float p_obsIpred_occl =
-                        sensor_->Probability(
-                            observations_[intersect_indices[i]]) *
-                        occlusion;
-
-                    sensor_->Condition(std::numeric_limits<float>::infinity(),
-                                       true);
-                    float p_obsIinf = sensor_->Probability(
-                        observations_[intersect_indices[i]]);
-
-                    log_likes[i_state] +=
-                        log((p_obsIpred_vis + p_obsIpred_occl) / p_obsIinf);
-
-                    // we update the occlusion with the observations
-                    if (update)
-                    {
-                        new_occlusions[i_state][intersect_indices[i]] =
-                            p_obsIpred_occl /
-                            (p_obsIpred_vis + p_obsIpred_occl);
-                        new_occlusion_times[i_state][intersect_indices[i]] =
-                            observation_time_;
-                    }
+                    owned_tiles[i_state][t] = tiles[t].use_count() == 1;
                 }
             }
         }
+
+        RealArray log_likes = RealArray::Zero(deltas.size());
+        executor_->parallel_for(
+            deltas.size(),
+            [&](int, size_t begin, size_t end)
+            {
+                likelihoods(begin,
+                            end,
+                            indices,
+                            update,
+                            log_likes,
+                            new_maps,
+                            exclusive,
+                            owned_tiles);
+            });
+
         if (update)
         {
-            occlusions_ = new_occlusions;
-            occlusion_times_ = new_occlusion_times;
+            occlusion_maps_.swap(new_maps);
             for (size_t i_state = 0; i_state < indices.size(); i_state++)
                 indices[i_state] = i_state;
         }
         return log_likes;
     }
 
+    /**
+     * \brief Sets the executor evaluating the likelihoods and rendering the
+     *        particles
+     */
+    void executor(const std::shared_ptr<Executor>& executor)
+    {
+        executor_ = executor;
+        object_model_->executor(executor);
+    }
+
+    std::shared_ptr<Executor> executor() const { return executor_; }
+
     void set_observation(const Observation& image)
     {
         assert(image.rows() == image.size());
@@ -236,51 +302,472 @@ public:
             std_measurement[i] = image(i, 0);
         }
 
-        set_observation(std_measurement, this->delta_time_);
+        set_observation(std_measurement);
     }
 
     virtual void reset()
     {
-        occlusions_.resize(1);
-        occlusions_[0] =
-            std::vector<float>(n_rows_ * n_cols_, initial_occlusion_);
-        occlusion_times_.resize(1);
-        occlusion_times_[0] = std::vector<double>(n_rows_ * n_cols_, 0);
-        observation_time_ = 0;
+        footprint_slots_.assign(n_rows_ * n_cols_, -1);
+        footprint_pixels_.clear();
+
+        occlusion_maps_.resize(1);
+        occlusion_maps_[0] = std::make_shared<OcclusionMap>();
+        frame_ = 0;
+    }
+
+    /**
+     * \brief Adds the integrated poses, the occlusion maps and the observation
+     *        time. Maps shared by several particles are stored once.
+     */
+    void save(CheckpointWriter& checkpoint) const
+    {
+        Base::save(checkpoint);
+
+        // each distinct map and tile is stored once, the particles refer to
+        // the maps and the maps to the tiles by index
+        std::unordered_map<const OcclusionMap*, int32_t> map_ids;
+        std::unordered_map<const OcclusionTile*, int32_t> tile_ids;
+        std::vector<int32_t> particle_maps;
+        std::vector<int32_t> map_sizes;
+        std::vector<int32_t> map_tiles;
+        std::vector<uint8_t> occlusions;
+        std::vector<uint16_t> frames;
+        std::vector<uint64_t> base_frames;
+        for (const OcclusionMapPtr& map : occlusion_maps_)
+        {
+            auto inserted = map_ids.insert(
+                std::make_pair(map.get(), int32_t(map_ids.size())));
+            particle_maps.push_back(inserted.first->second);
+            if (!inserted.second) continue;
+
+            map_sizes.push_back(map->tiles.size());
+            for (const OcclusionTilePtr& tile : map->tiles)
+            {
+                if (!tile)
+                {
+                    map_tiles.push_back(-1);
+                    continue;
+                }
+
+                auto tile_id = tile_ids.insert(
+                    std::make_pair(tile.get(), int32_t(tile_ids.size())));
+                if (tile_id.second)
+                {
+                    occlusions.insert(occlusions.end(),
+                                      tile->occlusions,
+                                      tile->occlusions + TILE_SIZE);
+                    frames.insert(
+                        frames.end(), tile->frames, tile->frames + TILE_SIZE);
+                    base_frames.push_back(tile->base_frame);
+                }
+                map_tiles.push_back(tile_id.first->second);
+            }
+        }
+
+        checkpoint.add("sensor/footprint", footprint_pixels_);
+        checkpoint.add("sensor/occlusion_maps", particle_maps);
+        checkpoint.add("sensor/occlusion_map_sizes", map_sizes);
+        checkpoint.add("sensor/occlusion_map_tiles", map_tiles);
+        checkpoint.add("sensor/occlusions", occlusions);
+        checkpoint.add("sensor/occlusion_frames", frames);
+        checkpoint.add("sensor/occlusion_base_frames", base_frames);
+        checkpoint.add("sensor/frame", &frame_, 1);
+    }
+
+    void load(const CheckpointReader& checkpoint)
+    {
+        std::vector<int32_t> footprint_pixels =
+            checkpoint.vector<int32_t>("sensor/footprint");
+        std::vector<int> footprint_slots(n_rows_ * n_cols_, -1);
+        for (size_t slot = 0; slot < footprint_pixels.size(); slot++)
+        {
+            const int pixel = footprint_pixels[slot];
+            if (pixel < 0 || size_t(pixel) >= footprint_slots.size())
+            {
+                throw CheckpointException(
+                    "the footprint does not match the image size");
+            }
+            footprint_slots[pixel] = slot;
+        }
+        const size_t tile_count =
+            (footprint_pixels.size() + TILE_SIZE - 1) / TILE_SIZE;
+
+        size_t value_count, frame_count;
+        const uint8_t* occlusions =
+            checkpoint.data<uint8_t>("sensor/occlusions", value_count);
+        const uint16_t* frames =
+            checkpoint.data<uint16_t>("sensor/occlusion_frames", frame_count);
+        std::vector<uint64_t> base_frames = checkpoint.vector<uint64_t>(
+            "sensor/occlusion_base_frames", value_count / TILE_SIZE);
+        if (value_count % TILE_SIZE != 0 || frame_count != value_count)
+        {
+            throw CheckpointException("invalid occlusion tiles");
+        }
+
+        std::vector<OcclusionTilePtr> tiles(value_count / TILE_SIZE);
+        for (size_t t = 0; t < tiles.size(); t++)
+        {
+            tiles[t] = std::make_shared<OcclusionTile>();
+            tiles[t]->base_frame = base_frames[t];
+            std::copy(occlusions + t * TILE_SIZE,
+                      occlusions + (t + 1) * TILE_SIZE,
+                      tiles[t]->occlusions);
+            std::copy(frames + t * TILE_SIZE,
+                      frames + (t + 1) * TILE_SIZE,
+                      tiles[t]->frames);
+        }
+
+        std::vector<int32_t> map_sizes =
+            checkpoint.vector<int32_t>("sensor/occlusion_map_sizes");
+        std::vector<int32_t> map_tiles =
+            checkpoint.vector<int32_t>("sensor/occlusion_map_tiles");
+        std::vector<OcclusionMapPtr> maps(map_sizes.size());
+        size_t offset = 0;
+        for (size_t i = 0; i < maps.size(); i++)
+        {
+            const size_t size = map_sizes[i];
+            if (map_sizes[i] < 0 || size > tile_count ||
+                size > map_tiles.size() - offset)
+            {
+                throw CheckpointException(
+                    "the occlusion maps do not match the footprint");
+            }
+
+            maps[i] = std::make_shared<OcclusionMap>();
+            maps[i]->tiles.resize(size);
+            for (size_t t = 0; t < size; t++)
+            {
+                const int32_t tile = map_tiles[offset + t];
+                if (tile >= int32_t(tiles.size()))
+                {
+                    throw CheckpointException("invalid occlusion tile index");
+                }
+                if (tile >= 0) maps[i]->tiles[t] = tiles[tile];
+            }
+            offset += size;
+        }
+
+        std::vector<int32_t> particle_maps =
+            checkpoint.vector<int32_t>("sensor/occlusion_maps");
+        std::vector<OcclusionMapPtr> occlusion_maps(particle_maps.size());
+        for (size_t i = 0; i < particle_maps.size(); i++)
+        {
+            if (particle_maps[i] < 0 ||
+                size_t(particle_maps[i]) >= maps.size())
+            {
+                throw CheckpointException("invalid occlusion map index");
+            }
+            occlusion_maps[i] = maps[particle_maps[i]];
+        }
+
+        const uint64_t frame =
+            checkpoint.vector<uint64_t>("sensor/frame", 1)[0];
+
+        // the checkpoint is consistent, restore the state
+        Base::load(checkpoint);
+        footprint_pixels_.swap(footprint_pixels);
+        footprint_slots_.swap(footprint_slots);
+        occlusion_maps_.swap(occlusion_maps);
+        frame_ = frame;
+    }
+
+    size_t state_count(const CheckpointReader& checkpoint) const
+    {
+        size_t count;
+        checkpoint.data<int32_t>("sensor/occlusion_maps", count);
+        return count;
     }
 
     // TODO: TYPES
     const std::vector<float> Occlusions(size_t index) const
     {
-        return occlusions_[index];
+        const OcclusionMap& map = *occlusion_maps_[index];
+
+        std::vector<float> occlusions(n_rows_ * n_cols_, initial_occlusion_);
+        for (size_t t = 0; t < map.tiles.size(); t++)
+        {
+            if (!map.tiles[t]) continue;
+
+            const size_t end = std::min<size_t>((t + 1) * TILE_SIZE,
+                                                footprint_pixels_.size());
+            for (size_t slot = t * TILE_SIZE; slot < end; slot++)
+            {
+                const uint8_t code =
+                    map.tiles[t]->occlusions[slot - t * TILE_SIZE];
+                occlusions[footprint_pixels_[slot]] =
+                    OcclusionQuantizer::decode(code);
+            }
+        }
+        return occlusions;
     }
 
+    /**
+     * \return the number of pixels the object has been projected onto since
+     *         the last reset
+     */
+    size_t footprint_size() const { return footprint_pixels_.size(); }
+
 private:
-    void set_observation(const std::vector<float>& observations,
-                         const Scalar& delta_time)
+    enum
+    {
+        TILE_SIZE = 256,
+        MAX_FRAME_OFFSET = 0xFFFF
+    };
+
+    /**
+     * \brief Occlusion probabilities and the frames of their last update of
+     *        TILE_SIZE consecutive slots of the footprint
+     *
+     * The probabilities are quantized by the OcclusionQuantizer and the frames
+     * are offsets from the base frame of the tile. Each slot takes 3 instead
+     * of the 12 bytes of a float probability and a double time.
+     */
+    struct OcclusionTile
+    {
+        uint64_t base_frame;
+        uint8_t occlusions[TILE_SIZE];
+        uint16_t frames[TILE_SIZE];
+    };
+
+    typedef std::shared_ptr<OcclusionTile> OcclusionTilePtr;
+
+    /**
+     * \brief Tiles covering the first slots of the footprint. Slots of
+     *        missing or null tiles have not been updated and keep the initial
+     *        occlusion.
+     */
+    struct OcclusionMap
+    {
+        std::vector<OcclusionTilePtr> tiles;
+    };
+
+    typedef std::shared_ptr<OcclusionMap> OcclusionMapPtr;
+
+    template <typename Model>
+    static const Model& exact_model(const std::shared_ptr<Model>& model)
+    {
+        if (typeid(*model) != typeid(Model))
+        {
+            throw std::invalid_argument(
+                "KinectImageModel evaluates the pixel and occlusion models "
+                "through their stateless policies, derived models are not "
+                "supported");
+        }
+        return *model;
+    }
+
+    size_t tile_count() const
+    {
+        return (footprint_pixels_.size() + TILE_SIZE - 1) / TILE_SIZE;
+    }
+
+    /**
+     * \brief Evaluates the likelihoods of the particles [begin, end) on the
+     *        rendered depth layers. Writes only to the entries, the exclusive
+     *        occlusion maps and the owned tiles of these particles, hence
+     *        disjoint ranges may be evaluated concurrently.
+     */
+    void likelihoods(size_t begin,
+                     size_t end,
+                     const IntArray& indices,
+                     bool update,
+                     RealArray& log_likes,
+                     std::vector<OcclusionMapPtr>& new_maps,
+                     const std::vector<char>& exclusive,
+                     std::vector<std::vector<char>>& owned_tiles)
+    {
+        // the observed pixels of a particle are gathered into contiguous
+        // arrays and evaluated by the pixel model at once
+        std::vector<int> slots;
+        std::vector<float> predictions;
+        std::vector<float> observations;
+        std::vector<float> occlusions;
+        std::vector<float> log_ratios;
+        std::vector<float> posteriors;
+
+        for (size_t i_state = begin; i_state < end; i_state++)
+        {
+            const OcclusionMap& map = *occlusion_maps_[indices[i_state]];
+            const int map_size = map.tiles.size() * TILE_SIZE;
+
+            const std::vector<int>& intersect_indices =
+                layer_cache_.depth(i_state).indices;
+            const std::vector<float>& depth =
+                layer_cache_.depth(i_state).depth;
+
+            // gather the pixels and predict their occlusions ------------------
+            slots.clear();
+            predictions.clear();
+            observations.clear();
+            occlusions.clear();
+            for (size_t j = 0; j < depth.size(); j++)
+            {
+                const int i = intersect_indices[j];
+
+                // missing observations do not contribute
+                if (std::isnan(observations_[i])) continue;
+
+                const int slot = footprint_slots_[i];
+                const OcclusionTile* tile =
+                    slot >= 0 && slot < map_size
+                        ? map.tiles[slot / TILE_SIZE].get()
+                        : nullptr;
+                const int tile_slot = slot % TILE_SIZE;
+                const uint64_t update_frame =
+                    tile ? tile->base_frame + tile->frames[tile_slot] : 0;
+                double delta_time =
+                    (frame_ - update_frame) * double(this->delta_time_);
+
+                slots.push_back(slot);
+                predictions.push_back(depth[j]);
+                observations.push_back(observations_[i]);
+                occlusions.push_back(occlusion_model_.predict(
+                    delta_time,
+                    tile ? OcclusionQuantizer::decode(
+                               tile->occlusions[tile_slot])
+                         : initial_occlusion_));
+            }
+
+            // compute likelihoods ---------------------------------------------
+            const int count = predictions.size();
+            log_ratios.resize(count);
+            posteriors.resize(count);
+            pixel_model_.log_likelihood_ratios(predictions.data(),
+                                               observations.data(),
+                                               occlusions.data(),
+                                               count,
+                                               log_ratios.data(),
+                                               update ? posteriors.data()
+                                                      : nullptr);
+
+            double log_like = 0;
+            for (int k = 0; k < count; k++) log_like += log_ratios[k];
+            log_likes[i_state] += log_like;
+
+            // we update the occlusion with the observations
+            if (!update || count == 0) continue;
+
+            if (!exclusive[i_state])
+            {
+                new_maps[i_state] = std::make_shared<OcclusionMap>(map);
+            }
+            OcclusionMap* new_map = new_maps[i_state].get();
+            new_map->tiles.resize(tile_count());
+            owned_tiles[i_state].resize(tile_count());
+
+            for (int k = 0; k < count; k++)
+            {
+                const int slot = slots[k];
+                const int tile_slot = slot % TILE_SIZE;
+
+                OcclusionTilePtr& new_tile = new_map->tiles[slot / TILE_SIZE];
+                char& owned = owned_tiles[i_state][slot / TILE_SIZE];
+                if (!owned)
+                {
+                    const OcclusionTile* tile =
+                        slot < map_size ? map.tiles[slot / TILE_SIZE].get()
+                                        : nullptr;
+                    new_tile = tile ? std::make_shared<OcclusionTile>(*tile)
+                                    : initial_tile();
+                    owned = true;
+                }
+
+                if (frame_ - new_tile->base_frame > MAX_FRAME_OFFSET)
+                {
+                    rebase(*new_tile);
+                }
+                new_tile->occlusions[tile_slot] =
+                    OcclusionQuantizer::encode(posteriors[k]);
+                new_tile->frames[tile_slot] = frame_ - new_tile->base_frame;
+            }
+        }
+    }
+
+    OcclusionTilePtr initial_tile() const
+    {
+        auto tile = std::make_shared<OcclusionTile>();
+        tile->base_frame = 0;
+        std::fill(tile->occlusions,
+                  tile->occlusions + TILE_SIZE,
+                  OcclusionQuantizer::encode(initial_occlusion_));
+        std::fill(tile->frames, tile->frames + TILE_SIZE, 0);
+        return tile;
+    }
+
+    /**
+     * \brief Moves the base frame of the tile such that the current frame is
+     *        the largest offset. Updates older than the new base frame are
+     *        moved to the base frame. They are at least 2^16 frames old, by
+     *        then the occlusion process has long converged.
+     */
+    void rebase(OcclusionTile& tile) const
+    {
+        const uint64_t base_frame = frame_ - MAX_FRAME_OFFSET;
+        for (int i = 0; i < TILE_SIZE; i++)
+        {
+            const uint64_t frame = tile.base_frame + tile.frames[i];
+            tile.frames[i] = frame > base_frame ? frame - base_frame : 0;
+        }
+        tile.base_frame = base_frame;
+    }
+
+    /**
+     * \brief Adds the observed pixels hit by any of the particles to the
+     *        footprint, such that the updated maps have a slot for each of
+     *        them
+     */
+    void extend_footprint(size_t particle_count)
+    {
+        for (size_t i_state = 0; i_state < particle_count; i_state++)
+        {
+            for (int i : layer_cache_.depth(i_state).indices)
+            {
+                if (footprint_slots_[i] >= 0 || std::isnan(observations_[i]))
+                {
+                    continue;
+                }
+                footprint_slots_[i] = footprint_pixels_.size();
+                footprint_pixels_.push_back(i);
+            }
+        }
+    }
+
+    void set_observation(const std::vector<float>& observations)
     {
         observations_ = observations;
-        observation_time_ += delta_time;
+        frame_++;
     }
 
     // TODO: WE PROBABLY DONT NEED ALL OF THIS
     const Eigen::Matrix3d camera_matrix_;
     const size_t n_rows_;
     const size_t n_cols_;
+    // quantized like the stored occlusions, such that pixels outside of the
+    // maps and untouched slots of the tiles start from the same probability
     const float initial_occlusion_;
     const std::shared_ptr<dbot::RigidBodiesState<-1>> rigid_bodies_state_;
 
-    // models
+    // models, stateless and shared by all executor threads
     ObjectRendererPtr object_model_;
-    PixelSensorPtr sensor_;
-    OcclusionModelPtr occlusion_transition_;
+    const PixelPolicy pixel_model_;
+    const OcclusionPolicy occlusion_model_;
+
+    // occlusion maps, shared by particles with a common ancestor until they
+    // update them. The maps only store the pixels of the footprint, i.e. the
+    // pixels onto which the object has been projected, in the slots given by
+    // the shared footprint index. Slots are grouped into copy on write tiles.
+    std::vector<OcclusionMapPtr> occlusion_maps_;
+    std::vector<int> footprint_slots_;
+    std::vector<int> footprint_pixels_;
+
+    // observed data, the time of a frame is its index times the delta time
+    std::vector<float> observations_;
+    uint64_t frame_;
 
-    // occlusion parameters
-    std::vector<std::vector<float>> occlusions_;
-    std::vector<std::vector<double>> occlusion_times_;
+    // depth layers of all parts and particles
+    DepthLayerCache layer_cache_;
 
-    // observed data
-    std::vector<float> observations_;
-    double observation_time_;
+    // parallel evaluation
+    std::shared_ptr<Executor> executor_;
 };
 }
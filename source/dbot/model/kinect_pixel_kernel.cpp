@@ -0,0 +1,422 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_pixel_kernel.cpp
+ * \date October 2016
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <dbot/model/kinect_pixel_kernel.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace dbot
+{
+namespace
+{
+#if defined(__AVX2__)
+/**
+ * \internal
+ * Operations on packs of 8 floats
+ */
+struct Pack
+{
+    enum
+    {
+        WIDTH = 8
+    };
+
+    typedef __m256 Real;
+    typedef __m256 Mask;
+    typedef __m256i Integer;
+
+    static Real load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, Real a) { _mm256_storeu_ps(p, a); }
+    static Real set(float a) { return _mm256_set1_ps(a); }
+    static Real add(Real a, Real b) { return _mm256_add_ps(a, b); }
+    static Real sub(Real a, Real b) { return _mm256_sub_ps(a, b); }
+    static Real mul(Real a, Real b) { return _mm256_mul_ps(a, b); }
+    static Real div(Real a, Real b) { return _mm256_div_ps(a, b); }
+    static Real madd(Real a, Real b, Real c)
+    {
+        return _mm256_fmadd_ps(a, b, c);
+    }
+    static Real min(Real a, Real b) { return _mm256_min_ps(a, b); }
+    static Real max(Real a, Real b) { return _mm256_max_ps(a, b); }
+    static Real abs(Real a)
+    {
+        return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a);
+    }
+    static Mask less(Real a, Real b)
+    {
+        return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+    }
+    static Real select(Mask m, Real a, Real b)
+    {
+        return _mm256_blendv_ps(b, a, m);
+    }
+    static Integer round(Real a) { return _mm256_cvtps_epi32(a); }
+    static Real convert(Integer n) { return _mm256_cvtepi32_ps(n); }
+
+    /// 2^n for -126 <= n <= 127
+    static Real pow2(Integer n)
+    {
+        return _mm256_castsi256_ps(_mm256_slli_epi32(
+            _mm256_add_epi32(n, _mm256_set1_epi32(127)), 23));
+    }
+
+    /// exponent e and mantissa m in [0.5, 1) of a = m 2^e for positive a
+    static Real exponent(Real a)
+    {
+        __m256i bits = _mm256_srli_epi32(_mm256_castps_si256(a), 23);
+        return _mm256_cvtepi32_ps(
+            _mm256_sub_epi32(bits, _mm256_set1_epi32(126)));
+    }
+    static Real mantissa(Real a)
+    {
+        __m256i bits = _mm256_and_si256(_mm256_castps_si256(a),
+                                        _mm256_set1_epi32(0x007fffff));
+        return _mm256_castsi256_ps(
+            _mm256_or_si256(bits, _mm256_set1_epi32(0x3f000000)));
+    }
+};
+
+#elif defined(__SSE2__)
+/**
+ * \internal
+ * Operations on packs of 4 floats
+ */
+struct Pack
+{
+    enum
+    {
+        WIDTH = 4
+    };
+
+    typedef __m128 Real;
+    typedef __m128 Mask;
+    typedef __m128i Integer;
+
+    static Real load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, Real a) { _mm_storeu_ps(p, a); }
+    static Real set(float a) { return _mm_set1_ps(a); }
+    static Real add(Real a, Real b) { return _mm_add_ps(a, b); }
+    static Real sub(Real a, Real b) { return _mm_sub_ps(a, b); }
+    static Real mul(Real a, Real b) { return _mm_mul_ps(a, b); }
+    static Real div(Real a, Real b) { return _mm_div_ps(a, b); }
+    static Real madd(Real a, Real b, Real c) { return add(mul(a, b), c); }
+    static Real min(Real a, Real b) { return _mm_min_ps(a, b); }
+    static Real max(Real a, Real b) { return _mm_max_ps(a, b); }
+    static Real abs(Real a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+    static Mask less(Real a, Real b) { return _mm_cmplt_ps(a, b); }
+    static Real select(Mask m, Real a, Real b)
+    {
+        return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    }
+    static Integer round(Real a) { return _mm_cvtps_epi32(a); }
+    static Real convert(Integer n) { return _mm_cvtepi32_ps(n); }
+
+    /// 2^n for -126 <= n <= 127
+    static Real pow2(Integer n)
+    {
+        return _mm_castsi128_ps(
+            _mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23));
+    }
+
+    /// exponent e and mantissa m in [0.5, 1) of a = m 2^e for positive a
+    static Real exponent(Real a)
+    {
+        __m128i bits = _mm_srli_epi32(_mm_castps_si128(a), 23);
+        return _mm_cvtepi32_ps(_mm_sub_epi32(bits, _mm_set1_epi32(126)));
+    }
+    static Real mantissa(Real a)
+    {
+        __m128i bits = _mm_and_si128(_mm_castps_si128(a),
+                                     _mm_set1_epi32(0x007fffff));
+        return _mm_castsi128_ps(
+            _mm_or_si128(bits, _mm_set1_epi32(0x3f000000)));
+    }
+};
+
+#else
+/**
+ * \internal
+ * Scalar fallback of the pack operations
+ */
+struct Pack
+{
+    enum
+    {
+        WIDTH = 1
+    };
+
+    typedef float Real;
+    typedef bool Mask;
+    typedef int32_t Integer;
+
+    static Real load(const float* p) { return *p; }
+    static void store(float* p, Real a) { *p = a; }
+    static Real set(float a) { return a; }
+    static Real add(Real a, Real b) { return a + b; }
+    static Real sub(Real a, Real b) { return a - b; }
+    static Real mul(Real a, Real b) { return a * b; }
+    static Real div(Real a, Real b) { return a / b; }
+    static Real madd(Real a, Real b, Real c) { return a * b + c; }
+    static Real min(Real a, Real b) { return std::min(a, b); }
+    static Real max(Real a, Real b) { return std::max(a, b); }
+    static Real abs(Real a) { return std::fabs(a); }
+    static Mask less(Real a, Real b) { return a < b; }
+    static Real select(Mask m, Real a, Real b) { return m ? a : b; }
+    static Integer round(Real a) { return Integer(std::nearbyint(a)); }
+    static Real convert(Integer n) { return Real(n); }
+
+    /// 2^n for -126 <= n <= 127
+    static Real pow2(Integer n)
+    {
+        const uint32_t bits = uint32_t(n + 127) << 23;
+        Real a;
+        std::memcpy(&a, &bits, sizeof(a));
+        return a;
+    }
+
+    /// exponent e and mantissa m in [0.5, 1) of a = m 2^e for positive a
+    static Real exponent(Real a)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &a, sizeof(bits));
+        return Real(int32_t(bits >> 23) - 126);
+    }
+    static Real mantissa(Real a)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &a, sizeof(bits));
+        bits = (bits & 0x007fffff) | 0x3f000000;
+        std::memcpy(&a, &bits, sizeof(a));
+        return a;
+    }
+};
+#endif
+
+typedef Pack::Real Real;
+
+/**
+ * \internal
+ * Cephes expf. The argument is clamped to the range of normal results.
+ */
+inline Real fast_exp(Real x)
+{
+    x = Pack::min(Pack::max(x, Pack::set(-87.f)), Pack::set(88.f));
+
+    const Pack::Integer n = Pack::round(Pack::mul(x, Pack::set(1.44269504f)));
+    const Real k = Pack::convert(n);
+    Real r = Pack::madd(k, Pack::set(-0.693359375f), x);
+    r = Pack::madd(k, Pack::set(2.12194440e-4f), r);
+
+    Real p = Pack::set(1.9875691500e-4f);
+    p = Pack::madd(p, r, Pack::set(1.3981999507e-3f));
+    p = Pack::madd(p, r, Pack::set(8.3334519073e-3f));
+    p = Pack::madd(p, r, Pack::set(4.1665795894e-2f));
+    p = Pack::madd(p, r, Pack::set(1.6666665459e-1f));
+    p = Pack::madd(p, r, Pack::set(5.0000001201e-1f));
+    p = Pack::madd(p, Pack::mul(r, r), Pack::add(r, Pack::set(1.f)));
+
+    return Pack::mul(p, Pack::pow2(n));
+}
+
+/**
+ * \internal
+ * Cephes logf for positive normal arguments
+ */
+inline Real fast_log(Real x)
+{
+    Real e = Pack::exponent(x);
+    Real m = Pack::mantissa(x);
+
+    // move the mantissa to [sqrt(0.5), sqrt(2))
+    const Pack::Mask low = Pack::less(m, Pack::set(0.707106781f));
+    e = Pack::sub(e, Pack::select(low, Pack::set(1.f), Pack::set(0.f)));
+    const Real t =
+        Pack::add(Pack::sub(m, Pack::set(1.f)),
+                  Pack::select(low, m, Pack::set(0.f)));
+    const Real t2 = Pack::mul(t, t);
+
+    Real p = Pack::set(7.0376836292e-2f);
+    p = Pack::madd(p, t, Pack::set(-1.1514610310e-1f));
+    p = Pack::madd(p, t, Pack::set(1.1676998740e-1f));
+    p = Pack::madd(p, t, Pack::set(-1.2420140846e-1f));
+    p = Pack::madd(p, t, Pack::set(1.4249322787e-1f));
+    p = Pack::madd(p, t, Pack::set(-1.6668057665e-1f));
+    p = Pack::madd(p, t, Pack::set(2.0000714765e-1f));
+    p = Pack::madd(p, t, Pack::set(-2.4999993993e-1f));
+    p = Pack::madd(p, t, Pack::set(3.3333331174e-1f));
+    p = Pack::mul(Pack::mul(p, t), t2);
+
+    p = Pack::madd(e, Pack::set(-2.12194440e-4f), p);
+    p = Pack::madd(t2, Pack::set(-0.5f), p);
+    return Pack::madd(e, Pack::set(0.693359375f), Pack::add(t, p));
+}
+
+/**
+ * \internal
+ * 1 + erf(x) using Abramowitz and Stegun 7.1.26. For negative x the
+ * complementary error function is evaluated directly to preserve the small
+ * values.
+ */
+inline Real one_plus_erf(Real x)
+{
+    const Real t = Pack::div(
+        Pack::set(1.f),
+        Pack::madd(Pack::abs(x), Pack::set(0.3275911f), Pack::set(1.f)));
+
+    Real p = Pack::set(1.061405429f);
+    p = Pack::madd(p, t, Pack::set(-1.453152027f));
+    p = Pack::madd(p, t, Pack::set(1.421413741f));
+    p = Pack::madd(p, t, Pack::set(-0.284496736f));
+    p = Pack::madd(p, t, Pack::set(0.254829592f));
+    p = Pack::mul(p, t);
+
+    const Real erfc = Pack::mul(
+        p, fast_exp(Pack::sub(Pack::set(0.f), Pack::mul(x, x))));
+    return Pack::select(Pack::less(x, Pack::set(0.f)),
+                        erfc,
+                        Pack::sub(Pack::set(2.f), erfc));
+}
+}
+
+KinectPixelKernel::KinectPixelKernel(double tail_weight,
+                                     double model_sigma,
+                                     double sigma_factor,
+                                     double half_life_depth,
+                                     double max_depth)
+    : lambda_(-std::log(0.5) / half_life_depth),
+      model_sigma_(model_sigma),
+      sigma_factor_(sigma_factor),
+      tail_(tail_weight / max_depth),
+      visible_weight_((1 - tail_weight) / std::sqrt(2 * M_PI)),
+      occluded_weight_((1 - tail_weight) * lambda_ / 2),
+      infinite_weight_((1 - tail_weight) * lambda_)
+{
+}
+
+void KinectPixelKernel::log_likelihood_ratios(const float* predictions,
+                                              const float* observations,
+                                              const float* occlusions,
+                                              int count,
+                                              float* log_ratios,
+                                              float* posteriors) const
+{
+    const Real one = Pack::set(1.f);
+    const Real lambda = Pack::set(lambda_);
+    const Real tail = Pack::set(tail_);
+
+    // the remainder is evaluated on padded copies
+    float padded[3][Pack::WIDTH];
+    float padded_results[2][Pack::WIDTH];
+
+    for (int i = 0; i < count; i += Pack::WIDTH)
+    {
+        const int width = std::min<int>(Pack::WIDTH, count - i);
+        const float* prediction_data = predictions + i;
+        const float* observation_data = observations + i;
+        const float* occlusion_data = occlusions + i;
+        if (width < Pack::WIDTH)
+        {
+            std::fill(&padded[0][0], &padded[0][0] + 3 * Pack::WIDTH, 1.f);
+            std::copy(predictions + i, predictions + count, padded[0]);
+            std::copy(observations + i, observations + count, padded[1]);
+            std::copy(occlusions + i, occlusions + count, padded[2]);
+            prediction_data = padded[0];
+            observation_data = padded[1];
+            occlusion_data = padded[2];
+        }
+
+        const Real prediction = Pack::load(prediction_data);
+        const Real observation = Pack::load(observation_data);
+        const Real occlusion = Pack::load(occlusion_data);
+
+        const Real sigma =
+            Pack::madd(Pack::mul(observation, observation),
+                       Pack::set(sigma_factor_),
+                       Pack::set(model_sigma_));
+        const Real inv_sigma = Pack::div(one, sigma);
+        const Real lambda_variance =
+            Pack::mul(lambda, Pack::mul(sigma, sigma));
+        const Real half_lambda_variance =
+            Pack::mul(Pack::set(0.5f * lambda_), lambda_variance);
+        const Real error = Pack::sub(prediction, observation);
+
+        // Gaussian around the prediction if the pixel is visible
+        const Real z = Pack::mul(error, inv_sigma);
+        const Real visible = Pack::madd(
+            Pack::mul(Pack::set(visible_weight_), inv_sigma),
+            fast_exp(Pack::mul(Pack::set(-0.5f), Pack::mul(z, z))),
+            tail);
+
+        // Gaussian convolved with the exponential distribution of occluders
+        // truncated at the prediction if it is occluded
+        const Real erf_argument =
+            Pack::mul(Pack::add(error, lambda_variance),
+                      Pack::mul(inv_sigma, Pack::set(0.707106781f)));
+        const Real occluder_density =
+            Pack::mul(fast_exp(Pack::madd(lambda, error, half_lambda_variance)),
+                      one_plus_erf(erf_argument));
+        const Real truncation =
+            Pack::sub(fast_exp(Pack::mul(lambda, prediction)), one);
+        const Real occluded =
+            Pack::madd(Pack::set(occluded_weight_),
+                       Pack::div(occluder_density, truncation),
+                       tail);
+
+        // the same for an infinite prediction
+        const Real infinite = Pack::madd(
+            Pack::set(infinite_weight_),
+            fast_exp(Pack::sub(half_lambda_variance,
+                               Pack::mul(lambda, observation))),
+            tail);
+
+        const Real weighted_occluded = Pack::mul(occluded, occlusion);
+        const Real mixture = Pack::madd(
+            visible, Pack::sub(one, occlusion), weighted_occluded);
+
+        float* log_ratio_data =
+            width < Pack::WIDTH ? padded_results[0] : log_ratios + i;
+        Pack::store(log_ratio_data, fast_log(Pack::div(mixture, infinite)));
+
+        float* posterior_data = nullptr;
+        if (posteriors)
+        {
+            posterior_data =
+                width < Pack::WIDTH ? padded_results[1] : posteriors + i;
+            Pack::store(posterior_data, Pack::div(weighted_occluded, mixture));
+        }
+
+        if (width < Pack::WIDTH)
+        {
+            std::copy(log_ratio_data, log_ratio_data + width, log_ratios + i);
+            if (posteriors)
+            {
+                std::copy(
+                    posterior_data, posterior_data + width, posteriors + i);
+            }
+        }
+    }
+}
+}
@@ -0,0 +1,75 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_pixel_kernel.h
+ * \date October 2016
+ */
+
+#pragma once
+
+namespace dbot
+{
+/**
+ * \brief Batched evaluation of the KinectPixelModel
+ *
+ * Evaluates the log ratio between the likelihood of an observed depth given
+ * the predicted depth and the occlusion probability of a pixel, and the
+ * likelihood given an infinite prediction, i.e. given that the object does
+ * not project onto the pixel. Optionally, the posterior occlusion probability
+ * is evaluated alongside.
+ *
+ * The pixels are processed in single precision, in packs of 8 with AVX2, 4
+ * with SSE2 or one at a time otherwise. exp, log and erf are replaced by
+ * polynomial approximations with a relative error of about 1e-7, the error
+ * of erf is below 1.5e-7. Evaluated over the depth range of the sensor the log
+ * ratios deviate from the double precision KinectPixelModel by less than 1e-4.
+ */
+class KinectPixelKernel
+{
+public:
+    /**
+     * \brief Takes the parameters of the KinectPixelModel
+     */
+    KinectPixelKernel(double tail_weight,
+                      double model_sigma,
+                      double sigma_factor,
+                      double half_life_depth,
+                      double max_depth);
+
+    /**
+     * \brief Evaluates \a count pixels. The predictions have to be finite
+     *        and positive, the observations must not be NaN.
+     *
+     * \param posteriors receives the posterior occlusion probabilities unless
+     *                   it is null
+     */
+    void log_likelihood_ratios(const float* predictions,
+                               const float* observations,
+                               const float* occlusions,
+                               int count,
+                               float* log_ratios,
+                               float* posteriors = nullptr) const;
+
+private:
+    float lambda_;
+    float model_sigma_;
+    float sigma_factor_;
+    // tail density, weight of the visible density including the normalizer
+    // of the Gaussian and weights of the occluded and infinite densities
+    float tail_;
+    float visible_weight_;
+    float occluded_weight_;
+    float infinite_weight_;
+};
+}
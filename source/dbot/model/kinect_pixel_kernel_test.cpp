@@ -0,0 +1,127 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_pixel_kernel_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <dbot/model/kinect_pixel_kernel.h>
+#include <dbot/model/kinect_pixel_model.h>
+
+namespace
+{
+/**
+ * Pixels covering the depth range of the sensor, observations around and far
+ * from the predictions and the whole range of occlusion probabilities. The
+ * count is not a multiple of the pack width.
+ */
+struct Pixels
+{
+    Pixels()
+    {
+        for (double prediction = 0.3; prediction < 6; prediction += 0.37)
+        {
+            for (double error = -0.5; error <= 0.5; error += 0.0013)
+            {
+                for (double occlusion : {0.0, 0.01, 0.3, 0.7, 0.99, 1.0})
+                {
+                    if (prediction + error <= 0) continue;
+
+                    predictions.push_back(prediction);
+                    observations.push_back(prediction + error);
+                    occlusions.push_back(occlusion);
+                }
+            }
+        }
+        predictions.push_back(2.0);
+        observations.push_back(2.0);
+        occlusions.push_back(0.5);
+    }
+
+    std::vector<float> predictions;
+    std::vector<float> observations;
+    std::vector<float> occlusions;
+};
+}
+
+TEST(KinectPixelKernelTests, matches_pixel_model)
+{
+    dbot::KinectPixelModel model(0.01, 0.003, 0.00142478, 1.0, 6.0);
+    dbot::KinectPixelKernel kernel = model.kernel();
+
+    Pixels pixels;
+    const int count = pixels.predictions.size();
+    std::vector<float> log_ratios(count);
+    std::vector<float> posteriors(count);
+    kernel.log_likelihood_ratios(pixels.predictions.data(),
+                                 pixels.observations.data(),
+                                 pixels.occlusions.data(),
+                                 count,
+                                 log_ratios.data(),
+                                 posteriors.data());
+
+    for (int i = 0; i < count; i++)
+    {
+        const double observation = pixels.observations[i];
+        const double occlusion = pixels.occlusions[i];
+
+        model.Condition(pixels.predictions[i], false);
+        const double visible = model.Probability(observation);
+        model.Condition(pixels.predictions[i], true);
+        const double occluded = model.Probability(observation);
+        model.Condition(std::numeric_limits<double>::infinity(), true);
+        const double infinite = model.Probability(observation);
+
+        const double mixture =
+            visible * (1 - occlusion) + occluded * occlusion;
+
+        ASSERT_NEAR(log_ratios[i], std::log(mixture / infinite), 1e-4)
+            << "prediction " << pixels.predictions[i] << ", observation "
+            << observation << ", occlusion " << occlusion;
+        ASSERT_NEAR(posteriors[i], occluded * occlusion / mixture, 1e-4)
+            << "prediction " << pixels.predictions[i] << ", observation "
+            << observation << ", occlusion " << occlusion;
+    }
+}
+
+TEST(KinectPixelKernelTests, remainder_matches_full_packs)
+{
+    dbot::KinectPixelKernel kernel(0.01, 0.003, 0.00142478, 1.0, 6.0);
+
+    Pixels pixels;
+    std::vector<float> log_ratios(pixels.predictions.size());
+    kernel.log_likelihood_ratios(pixels.predictions.data(),
+                                 pixels.observations.data(),
+                                 pixels.occlusions.data(),
+                                 log_ratios.size(),
+                                 log_ratios.data());
+
+    // evaluating one pixel at a time takes the padded path for each of them
+    for (size_t i = 0; i < log_ratios.size(); i += 97)
+    {
+        float log_ratio;
+        kernel.log_likelihood_ratios(&pixels.predictions[i],
+                                     &pixels.observations[i],
+                                     &pixels.occlusions[i],
+                                     1,
+                                     &log_ratio);
+        EXPECT_EQ(log_ratio, log_ratios[i]);
+    }
+}
@@ -30,6 +30,7 @@
 
 #include <Eigen/Dense>
 #include <cmath>
+#include <dbot/model/kinect_pixel_kernel.h>
 #include <dbot/traits.h>
 #include <iostream>
 
@@ -74,10 +75,23 @@ public:
           tail_weight_(tail_weight),
           model_sigma_(model_sigma),
           sigma_factor_(sigma_factor),
+          half_life_depth_(half_life_depth),
           max_depth_(max_depth)
     {
     }
 
+    /**
+     * \return a kernel evaluating this model on batches of pixels
+     */
+    KinectPixelKernel kernel() const
+    {
+        return KinectPixelKernel(tail_weight_,
+                                 model_sigma_,
+                                 sigma_factor_,
+                                 half_life_depth_,
+                                 max_depth_);
+    }
+
     virtual ~KinectPixelModel() noexcept {}
     virtual Scalar Probability(const Observation& observation) const
     {
@@ -138,7 +152,8 @@ public:
     }
 
 private:
-    const Scalar lambda_, tail_weight_, model_sigma_, sigma_factor_, max_depth_;
+    const Scalar lambda_, tail_weight_, model_sigma_, sigma_factor_,
+        half_life_depth_, max_depth_;
 
     Scalar prediction_;
     bool occlusion_;
@@ -29,12 +29,16 @@
 
 #pragma once
 
+#include <dbot/model/occlusion_process.h>
+
 // TODO: THIS IS JUST A LINEAR GAUSSIAN PROCESS WITH NO NOISE, SHOULD DISAPPEAR
 namespace dbot
 {
 
 /**
- * \class OcclusionProcess
+ * \class OcclusionModel
+ *
+ * Conditional interface of the stateless OcclusionProcess
  *
  * \ingroup distributions
  * \ingroup transitions
@@ -46,10 +50,8 @@ public:
     // and prob of source being object given one sec ago source was not object
     OcclusionModel(double p_occluded_visible,
                           double p_occluded_occluded):
-                                      p_occluded_visible_(p_occluded_visible),
-                                      p_occluded_occluded_(p_occluded_occluded),
-                                      c_(p_occluded_occluded_ - p_occluded_visible_),
-                                      log_c_(std::log(c_)) { }
+                                      process_(p_occluded_visible,
+                                               p_occluded_occluded) { }
 
     virtual ~OcclusionModel() noexcept {}
 
@@ -63,33 +65,19 @@ public:
 
     virtual double MapStandardGaussian() const
     {
-        double pow_c_time = std::exp(delta_time_*log_c_);
-
-        double new_occlusion_probability =
-                1. - (pow_c_time*(1.-occlusion_probability_) +
-                    (1 - p_occluded_occluded_)*(pow_c_time-1.)/(c_-1.));
-
-        if(new_occlusion_probability < 0.0 || new_occlusion_probability > 1.0)
-        {
-            if(std::fabs(c_ - 1.0) < 0.000000001)
-            {
-                new_occlusion_probability = occlusion_probability_;
-            }
-            else
-            {
-                std::cout << "unhandeled case in occlusion process mdoel " << std::endl;
-                exit(-1);
-            }
-        }
-
-        return new_occlusion_probability;
+        return process_.predict(delta_time_, occlusion_probability_);
     }
 
+    /**
+     * \return the stateless process this model conditions
+     */
+    const OcclusionProcess& process() const { return process_; }
+
 private:
     // conditionals
     double occlusion_probability_, delta_time_;
     // parameters
-    double p_occluded_visible_, p_occluded_occluded_, c_, log_c_;
+    OcclusionProcess process_;
 };
 
 }
@@ -0,0 +1,83 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file occlusion_process.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace dbot
+{
+/**
+ * \brief Two state Markov process of the occlusion of a pixel
+ *
+ * Predicts the occlusion probability of a pixel after some time given its
+ * current occlusion probability. Unlike the OcclusionModel it has no
+ * conditioning state, hence a single instance may be used by any number of
+ * threads and the prediction can be inlined into the pixel loop.
+ */
+class OcclusionProcess
+{
+public:
+    /**
+     * \param p_occluded_visible  probability of the pixel being occluded given
+     *                            it has been visible one second ago
+     * \param p_occluded_occluded probability of the pixel being occluded given
+     *                            it has been occluded one second ago
+     *
+     * \throws std::invalid_argument unless
+     *         0 <= p_occluded_visible < p_occluded_occluded <= 1
+     */
+    OcclusionProcess(double p_occluded_visible, double p_occluded_occluded)
+        : p_occluded_occluded_(p_occluded_occluded),
+          c_(p_occluded_occluded - p_occluded_visible),
+          log_c_(std::log(c_))
+    {
+        if (!(0. <= p_occluded_visible &&
+              p_occluded_visible < p_occluded_occluded &&
+              p_occluded_occluded <= 1.))
+        {
+            throw std::invalid_argument(
+                "the occlusion process requires 0 <= p_occluded_visible < "
+                "p_occluded_occluded <= 1");
+        }
+    }
+
+    /**
+     * \return the occlusion probability after \a delta_time seconds
+     */
+    double predict(double delta_time, double occlusion_probability) const
+    {
+        // both states are absorbing
+        if (std::fabs(c_ - 1.0) < 0.000000001) return occlusion_probability;
+
+        double pow_c_time = std::exp(delta_time * log_c_);
+
+        double new_occlusion_probability =
+            1. - (pow_c_time * (1. - occlusion_probability) +
+                  (1 - p_occluded_occluded_) * (pow_c_time - 1.) / (c_ - 1.));
+
+        // rounding may leave the unit interval
+        return std::min(std::max(new_occlusion_probability, 0.), 1.);
+    }
+
+private:
+    double p_occluded_occluded_, c_, log_c_;
+};
+}
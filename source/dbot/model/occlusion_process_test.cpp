@@ -0,0 +1,57 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file occlusion_process_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include <dbot/model/occlusion_process.h>
+
+TEST(OcclusionProcessTests, predictions_stay_probabilities)
+{
+    dbot::OcclusionProcess process(0.1, 0.7);
+
+    for (double delta_time : {0., 0.03, 1., 100.})
+    {
+        for (double occlusion : {0., 1e-7, 0.1, 0.5, 1. - 1e-7, 1.})
+        {
+            const double prediction = process.predict(delta_time, occlusion);
+            EXPECT_GE(prediction, 0.);
+            EXPECT_LE(prediction, 1.);
+        }
+    }
+
+    EXPECT_DOUBLE_EQ(process.predict(0., 0.3), 0.3);
+
+    // the stationary probability is p_ov / (1 - p_oo + p_ov)
+    EXPECT_NEAR(process.predict(100., 0.9), 0.1 / 0.4, 1e-9);
+}
+
+TEST(OcclusionProcessTests, absorbing_states_keep_probability)
+{
+    dbot::OcclusionProcess process(0., 1.);
+    EXPECT_EQ(process.predict(1., 0.3), 0.3);
+}
+
+TEST(OcclusionProcessTests, invalid_parameters_throw)
+{
+    EXPECT_THROW(dbot::OcclusionProcess(0.7, 0.1), std::invalid_argument);
+    EXPECT_THROW(dbot::OcclusionProcess(0.5, 0.5), std::invalid_argument);
+    EXPECT_THROW(dbot::OcclusionProcess(-0.1, 0.5), std::invalid_argument);
+    EXPECT_THROW(dbot::OcclusionProcess(0.1, 1.5), std::invalid_argument);
+}
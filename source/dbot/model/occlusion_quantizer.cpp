@@ -0,0 +1,42 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file occlusion_quantizer.cpp
+ * \date October 2016
+ */
+
+#include <dbot/model/occlusion_quantizer.h>
+
+namespace dbot
+{
+namespace
+{
+std::array<float, OcclusionQuantizer::CODE_COUNT> decode_table()
+{
+    const double step = 2. * OcclusionQuantizer::MAX_LOGIT /
+                        (OcclusionQuantizer::CODE_COUNT - 1);
+
+    std::array<float, OcclusionQuantizer::CODE_COUNT> table;
+    for (int code = 0; code < OcclusionQuantizer::CODE_COUNT; code++)
+    {
+        double logit = code * step - OcclusionQuantizer::MAX_LOGIT;
+        table[code] = float(1. / (1. + std::exp(-logit)));
+    }
+    return table;
+}
+}
+
+const std::array<float, OcclusionQuantizer::CODE_COUNT>
+    OcclusionQuantizer::table_ = decode_table();
+}
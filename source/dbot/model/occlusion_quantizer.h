@@ -0,0 +1,62 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file occlusion_quantizer.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace dbot
+{
+/**
+ * \brief Quantizes occlusion probabilities to 8 bit codes
+ *
+ * The codes are spaced uniformly in the logit log(p / (1 - p)) within
+ * [-MAX_LOGIT, MAX_LOGIT], i.e. probabilities in [3.4e-4, 1 - 3.4e-4]. In
+ * contrast to a uniform spacing in p this resolves the probabilities close to
+ * zero and one, where the likelihood is most sensitive to the occlusion.
+ * Decoding is a table lookup.
+ */
+class OcclusionQuantizer
+{
+public:
+    enum
+    {
+        MAX_LOGIT = 8,
+        CODE_COUNT = 256
+    };
+
+    static uint8_t encode(float occlusion)
+    {
+        const float max_logit = float(MAX_LOGIT);
+        const float scale = (CODE_COUNT - 1) / (2.f * max_logit);
+
+        float logit = std::log(occlusion) - std::log1p(-occlusion);
+        logit = logit > -max_logit ? logit : -max_logit;
+        logit = logit < max_logit ? logit : max_logit;
+
+        return uint8_t(std::lround((logit + max_logit) * scale));
+    }
+
+    static float decode(uint8_t code) { return table_[code]; }
+
+private:
+    static const std::array<float, CODE_COUNT> table_;
+};
+}
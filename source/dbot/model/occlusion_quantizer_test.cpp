@@ -0,0 +1,84 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file occlusion_quantizer_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <dbot/model/occlusion_quantizer.h>
+
+using dbot::OcclusionQuantizer;
+
+namespace
+{
+double logit(double p)
+{
+    return std::log(p / (1. - p));
+}
+
+const double logit_step =
+    2. * OcclusionQuantizer::MAX_LOGIT / (OcclusionQuantizer::CODE_COUNT - 1);
+}
+
+TEST(OcclusionQuantizerTests, codes_round_trip)
+{
+    for (int code = 0; code < OcclusionQuantizer::CODE_COUNT; code++)
+    {
+        EXPECT_EQ(OcclusionQuantizer::encode(OcclusionQuantizer::decode(code)),
+                  code);
+    }
+}
+
+TEST(OcclusionQuantizerTests, decoding_is_monotonic_and_symmetric)
+{
+    for (int code = 1; code < OcclusionQuantizer::CODE_COUNT; code++)
+    {
+        EXPECT_LT(OcclusionQuantizer::decode(code - 1),
+                  OcclusionQuantizer::decode(code));
+        EXPECT_NEAR(OcclusionQuantizer::decode(code) +
+                        OcclusionQuantizer::decode(255 - code),
+                    1.,
+                    1e-6);
+    }
+}
+
+TEST(OcclusionQuantizerTests, error_is_within_half_a_logit_step)
+{
+    for (double p = 1e-3; p < 1. - 1e-3; p += 1e-4)
+    {
+        double decoded = OcclusionQuantizer::decode(
+            OcclusionQuantizer::encode(float(p)));
+
+        EXPECT_LE(std::fabs(logit(decoded) - logit(p)), logit_step / 2 + 1e-4)
+            << p;
+        // the slope of the logistic function is at most p (1 - p)
+        EXPECT_LE(std::fabs(decoded - p), 0.25 * logit_step / 2 + 1e-5) << p;
+    }
+}
+
+TEST(OcclusionQuantizerTests, extremes_are_clamped)
+{
+    const double min =
+        1. / (1. + std::exp(double(OcclusionQuantizer::MAX_LOGIT)));
+
+    EXPECT_EQ(OcclusionQuantizer::encode(0.f), 0);
+    EXPECT_EQ(OcclusionQuantizer::encode(1e-9f), 0);
+    EXPECT_EQ(OcclusionQuantizer::encode(1.f), 255);
+    EXPECT_NEAR(OcclusionQuantizer::decode(0), min, 1e-7);
+    EXPECT_NEAR(OcclusionQuantizer::decode(255), 1. - min, 1e-7);
+}
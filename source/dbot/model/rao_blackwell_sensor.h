@@ -28,9 +28,14 @@
 
 #pragma once
 
+#include <limits>
+#include <memory>
+
 #include <Eigen/Core>
 
 #include <fl/util/types.hpp>
+#include <dbot/checkpoint.h>
+#include <dbot/executor.h>
 #include <dbot/pose/pose_vector.h>
 #include <dbot/pose/pose_velocity_vector.h>
 #include <dbot/pose/free_floating_rigid_bodies_state.h>
@@ -77,6 +82,61 @@ public:
     virtual PoseArray& integrated_poses() { return default_poses_; }
     virtual void reset() = 0;
 
+    /// parallel execution *****************************************************
+    /**
+     * \brief Sets the executor evaluating the likelihoods of the particles.
+     *        Sensors which evaluate serially ignore it.
+     */
+    virtual void executor(const std::shared_ptr<Executor>& executor) {}
+
+    /**
+     * \return the executor evaluating the likelihoods or nullptr if the
+     *         sensor evaluates serially
+     */
+    virtual std::shared_ptr<Executor> executor() const { return nullptr; }
+
+    /// checkpoints ************************************************************
+    /**
+     * \brief Adds the integrated poses to the checkpoint. Sensors keeping
+     *        further state across filter steps add it as well.
+     */
+    virtual void save(CheckpointWriter& checkpoint) const
+    {
+        checkpoint.add("sensor/integrated_poses",
+                       default_poses_.data(),
+                       default_poses_.size());
+    }
+
+    /**
+     * \brief Restores the state saved by save(). The sensor is left
+     *        unchanged if the checkpoint is rejected.
+     *
+     * \throws CheckpointException if the checkpoint does not match the
+     *         sensor
+     */
+    virtual void load(const CheckpointReader& checkpoint)
+    {
+        std::vector<double> poses = checkpoint.vector<double>(
+            "sensor/integrated_poses", default_poses_.size());
+        for (int i = 0; i < default_poses_.size(); i++)
+        {
+            default_poses_(i) = poses[i];
+        }
+    }
+
+    /**
+     * \brief Number of particle states load() restores from the checkpoint.
+     *        The indices passed to loglikes() afterwards have to be below it.
+     *        Sensors without particle states accept any index.
+     *
+     * \throws CheckpointException if the checkpoint does not match the
+     *         sensor
+     */
+    virtual size_t state_count(const CheckpointReader&) const
+    {
+        return std::numeric_limits<size_t>::max();
+    }
+
 protected:
     fl::Real delta_time_;
     PoseArray default_poses_;
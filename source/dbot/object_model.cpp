@@ -17,6 +17,9 @@
  * \author Jan Issac (jan.issac@gmail.com)
  */
 
+#include <algorithm>
+
+#include <dbot/mesh_simplification.h>
 #include <dbot/object_model.h>
 
 namespace dbot
@@ -31,6 +34,8 @@ void ObjectModel::load_from(const std::shared_ptr<ObjectModelLoader>& loader,
                             bool center)
 {
     loader->load(vertices_, triangle_indices_);
+    level_vertices_.clear();
+    level_triangle_indices_.clear();
     compute_centers(centers_);
 
     if (center) center_vertices(centers_, vertices_);
@@ -46,6 +51,63 @@ auto ObjectModel::triangle_indices() const -> const TriangleIndecies &
     return triangle_indices_;
 }
 
+void ObjectModel::generate_levels(int level_count, double reduction)
+{
+    std::vector<Vertices> level_vertices;
+    std::vector<TriangleIndecies> level_indices;
+    generate_levels(level_count, reduction, level_vertices, level_indices);
+
+    level_vertices_.swap(level_vertices);
+    level_triangle_indices_.swap(level_indices);
+}
+
+void ObjectModel::generate_levels(
+    int level_count,
+    double reduction,
+    std::vector<Vertices>& level_vertices,
+    std::vector<TriangleIndecies>& level_indices) const
+{
+    level_vertices.assign(std::max(level_count - 1, 0), Vertices());
+    level_indices.assign(std::max(level_count - 1, 0), TriangleIndecies());
+
+    for (int level = 1; level < level_count; level++)
+    {
+        const Vertices& previous_vertices =
+            level == 1 ? vertices_ : level_vertices[level - 2];
+        const TriangleIndecies& previous_indices =
+            level == 1 ? triangle_indices_ : level_indices[level - 2];
+
+        Vertices& vertices = level_vertices[level - 1];
+        TriangleIndecies& indices = level_indices[level - 1];
+        vertices.resize(previous_vertices.size());
+        indices.resize(previous_indices.size());
+
+        for (size_t i = 0; i < previous_vertices.size(); i++)
+        {
+            simplify_mesh(previous_vertices[i],
+                          previous_indices[i],
+                          size_t(reduction * previous_indices[i].size()),
+                          vertices[i],
+                          indices[i]);
+        }
+    }
+}
+
+int ObjectModel::count_levels() const
+{
+    return level_vertices_.size() + 1;
+}
+
+auto ObjectModel::vertices(int level) const -> const Vertices &
+{
+    return level == 0 ? vertices_ : level_vertices_[level - 1];
+}
+
+auto ObjectModel::triangle_indices(int level) const -> const TriangleIndecies &
+{
+    return level == 0 ? triangle_indices_ : level_triangle_indices_[level - 1];
+}
+
 const std::vector<Eigen::Vector3d>& ObjectModel::centers() const
 {
     return centers_;
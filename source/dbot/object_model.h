@@ -48,6 +48,30 @@ public:
 
     const TriangleIndecies& triangle_indices() const;
 
+    /**
+     * \brief Generates level_count - 1 coarser versions of all parts by
+     *        quadric error simplification. Each level keeps the given
+     *        fraction of the triangles of the previous one. Level 0 is the
+     *        loaded mesh.
+     */
+    void generate_levels(int level_count, double reduction);
+
+    /**
+     * \brief Same as above but leaves the model unchanged. The coarser levels
+     *        are returned in \a level_vertices and \a level_indices, i.e.
+     *        without the loaded mesh.
+     */
+    void generate_levels(int level_count,
+                         double reduction,
+                         std::vector<Vertices>& level_vertices,
+                         std::vector<TriangleIndecies>& level_indices) const;
+
+    int count_levels() const;
+
+    const Vertices& vertices(int level) const;
+
+    const TriangleIndecies& triangle_indices(int level) const;
+
     const std::vector<Eigen::Vector3d>& centers() const;
 
     int count_parts() const;
@@ -63,5 +87,9 @@ private:
 
     std::vector<std::vector<Eigen::Vector3d>> vertices_;
     std::vector<std::vector<std::vector<int>>> triangle_indices_;
+
+    // levels of detail 1 and above
+    std::vector<Vertices> level_vertices_;
+    std::vector<TriangleIndecies> level_triangle_indices_;
 };
 }
@@ -17,6 +17,10 @@
  */
 
 #include <dbot/rigid_body_renderer.h>
+#include <dbot/tile_rasterizer.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <iostream>
 #include <limits>
 
@@ -32,6 +36,7 @@ RigidBodyRenderer::RigidBodyRenderer(
 {
     camera_matrix_.setZero();
     init();
+    update_rays();
 }
 
 RigidBodyRenderer::RigidBodyRenderer(
@@ -47,13 +52,22 @@ RigidBodyRenderer::RigidBodyRenderer(
       indices_(indices)
 {
     init();
+    update_rays();
 }
 
 void RigidBodyRenderer::init()
 {
+    rasterizer_ = Rasterizer::Tiled;
+    precision_ = Precision::Single;
+    back_face_culling_ = false;
+    frustum_culling_ = true;
+    lod_pixels_per_triangle_ = 4.;
+    revision_ = 0;
+
     /// initialize poses *******************************************************
-    R_.resize(vertices_.size());
-    t_.resize(vertices_.size());
+    part_count_ = vertices_.size();
+    R_.resize(part_count_);
+    t_.resize(part_count_);
 
     for (size_t i = 0; i < R_.size(); i++)
     {
@@ -61,234 +75,880 @@ void RigidBodyRenderer::init()
         t_[i] = Vector::Zero();
     }
 
+    /// each part is its own finest level of detail ****************************
+    levels_.resize(part_count_);
+    for (size_t i = 0; i < part_count_; i++)
+    {
+        levels_[i] = {i};
+    }
+
+    update_meshes();
+}
+
+void RigidBodyRenderer::update_meshes()
+{
     /// compute normals ********************************************************
     normals_.clear();
-    for (size_t part_index = 0; part_index < indices_.size(); part_index++)
+    for (size_t mesh_index = 0; mesh_index < indices_.size(); mesh_index++)
     {
-        vector<Vector3d> part_normals(indices_[part_index].size());
+        vector<Vector3d> part_normals(indices_[mesh_index].size());
         for (int triangle_index = 0; triangle_index < int(part_normals.size());
              triangle_index++)
         {
-            // compute the three cross products and make sure that they yield
-            // the same normal
-            vector<Vector3d> temp_normals(3);
-            for (int vertex_index = 0; vertex_index < 3; vertex_index++)
-                temp_normals[vertex_index] =
-                    ((vertices_[part_index][indices_[part_index][triangle_index]
-                                                    [(vertex_index + 1) % 3]] -
-                      vertices_[part_index][indices_[part_index][triangle_index]
-                                                    [vertex_index]])
-                         .cross(vertices_[part_index]
-                                         [indices_[part_index][triangle_index]
-                                                  [(vertex_index + 2) % 3]] -
-                                vertices_[part_index]
-                                         [indices_[part_index][triangle_index]
-                                                  [(vertex_index + 1) % 3]]))
-                        .normalized();
-
-            for (int vertex_index = 0; vertex_index < 3; vertex_index++)
-                if (!temp_normals[vertex_index].isApprox(
-                        temp_normals[(vertex_index + 1) % 3]))
-                {
-                    cout << "error, part_normals are not equal, probably the "
-                            "triangle is degenerate."
-                         << endl;
-                    cout << "normal 1 " << endl
-                         << temp_normals[vertex_index] << endl;
-                    cout << "normal 2 " << endl
-                         << temp_normals[(vertex_index + 1) % 3] << endl;
-                    exit(-1);
-                }
-            part_normals[triangle_index] = temp_normals[0];
+            // a single cross product per face, the cross products at the
+            // other corners differ by rounding errors which grow for thin
+            // triangles
+            const vector<int>& triangle = indices_[mesh_index][triangle_index];
+            const Vector3d normal =
+                (vertices_[mesh_index][triangle[1]] -
+                 vertices_[mesh_index][triangle[0]])
+                    .cross(vertices_[mesh_index][triangle[2]] -
+                           vertices_[mesh_index][triangle[1]]);
+
+            const double norm = normal.norm();
+            if (!(norm > 0) || !std::isfinite(norm))
+            {
+                cout << "error, the normal of triangle " << triangle_index
+                     << " can not be computed, the triangle is degenerate."
+                     << endl;
+                exit(-1);
+            }
+            part_normals[triangle_index] = normal / norm;
         }
         normals_.push_back(part_normals);
     }
+
+    /// compute bounding spheres and orientations ******************************
+    centers_.clear();
+    radii_.clear();
+    orientations_.clear();
+    for (size_t mesh_index = 0; mesh_index < vertices_.size(); mesh_index++)
+    {
+        const vector<Vector3d>& part_vertices = vertices_[mesh_index];
+
+        Vector3d min = Vector3d::Constant(numeric_limits<double>::max());
+        Vector3d max = -min;
+        for (const Vector3d& vertex : part_vertices)
+        {
+            min = min.cwiseMin(vertex);
+            max = max.cwiseMax(vertex);
+        }
+        Vector3d center = Vector3d::Zero();
+        if (!part_vertices.empty()) center = (min + max) / 2.;
+
+        double radius = 0;
+        for (const Vector3d& vertex : part_vertices)
+        {
+            radius = std::max(radius, (vertex - center).norm());
+        }
+
+        double volume = 0;
+        for (const vector<int>& triangle : indices_[mesh_index])
+        {
+            volume += part_vertices[triangle[0]].dot(
+                part_vertices[triangle[1]].cross(part_vertices[triangle[2]]));
+        }
+
+        centers_.push_back(center);
+        radii_.push_back(radius);
+        orientations_.push_back(volume < 0 ? -1. : 1.);
+    }
+
+    // the sphere of a part has to contain all of its levels of detail
+    for (size_t part_index = 0; part_index < part_count_; part_index++)
+    {
+        for (size_t mesh_index : levels_[part_index])
+        {
+            for (const Vector3d& vertex : vertices_[mesh_index])
+            {
+                radii_[part_index] =
+                    std::max(radii_[part_index],
+                             (vertex - centers_[part_index]).norm());
+            }
+        }
+    }
+
+    /// pack vertices and normals for the single precision path ***************
+    packed_vertices_.clear();
+    packed_normals_.clear();
+    for (size_t mesh_index = 0; mesh_index < vertices_.size(); mesh_index++)
+    {
+        const vector<Vector3d>& part_vertices = vertices_[mesh_index];
+        const size_t n = part_vertices.size();
+        vector<float> vertices(3 * n);
+        for (size_t i = 0; i < n; i++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                vertices[k * n + i] = part_vertices[i](k);
+            }
+        }
+
+        const size_t m = normals_[mesh_index].size();
+        vector<float> normals(4 * m);
+        for (size_t i = 0; i < m; i++)
+        {
+            const Vector3d& normal = normals_[mesh_index][i];
+            for (int k = 0; k < 3; k++)
+            {
+                normals[k * m + i] = normal(k);
+            }
+            normals[3 * m + i] =
+                normal.dot(part_vertices[indices_[mesh_index][i][0]]);
+        }
+
+        packed_vertices_.push_back(vertices);
+        packed_normals_.push_back(normals);
+    }
 }
 
 RigidBodyRenderer::~RigidBodyRenderer()
 {
 }
 
-// todo: does not handle the case properly when the depth is around zero or
-// negative
 void RigidBodyRenderer::Render(Matrix camera_matrix,
                                int n_rows,
                                int n_cols,
                                std::vector<float>& depth_image) const
+{
+    depth_image =
+        vector<float>(n_rows * n_cols, numeric_limits<float>::infinity());
+
+    RenderContext context;
+    render(R_,
+           t_,
+           camera_matrix,
+           image_rect(n_rows, n_cols),
+           context,
+           depth_image.data());
+}
+
+void RigidBodyRenderer::RenderBatch(
+    const std::vector<std::vector<Affine>>& poses,
+    const Matrix& camera_matrix,
+    int n_rows,
+    int n_cols,
+    std::vector<float>& depth_atlas) const
+{
+    BatchContext context;
+    RenderBatch(poses, camera_matrix, n_rows, n_cols, context, depth_atlas);
+}
+
+void RigidBodyRenderer::RenderBatch(
+    const std::vector<std::vector<Affine>>& poses,
+    const Matrix& camera_matrix,
+    int n_rows,
+    int n_cols,
+    BatchContext& context,
+    std::vector<float>& depth_atlas) const
+{
+    const size_t pixel_count = n_rows * n_cols;
+    if (depth_atlas.size() != poses.size() * pixel_count)
+    {
+        depth_atlas.resize(poses.size() * pixel_count);
+    }
+
+    const size_t chunk_count = executor_ ? executor_->thread_count() : 1;
+    if (context.chunks.size() < chunk_count)
+    {
+        context.chunks.resize(chunk_count);
+    }
+
+    auto task = [&](int chunk, size_t begin, size_t end)
+    {
+        BatchContext::Chunk& scratch = context.chunks[chunk];
+        vector<Matrix>& R = scratch.R;
+        vector<Vector>& t = scratch.t;
+        for (size_t i = begin; i < end; i++)
+        {
+            R.resize(poses[i].size());
+            t.resize(poses[i].size());
+            for (size_t k = 0; k < poses[i].size(); k++)
+            {
+                R[k] = poses[i][k].rotation();
+                t[k] = poses[i][k].translation();
+            }
+
+            float* depth_image = depth_atlas.data() + i * pixel_count;
+            std::fill(depth_image,
+                      depth_image + pixel_count,
+                      numeric_limits<float>::infinity());
+
+            render(R,
+                   t,
+                   camera_matrix,
+                   image_rect(n_rows, n_cols),
+                   scratch.context,
+                   depth_image);
+        }
+    };
+
+    if (executor_)
+    {
+        // the reference wrapper keeps the task from being copied to the heap
+        executor_->parallel_for(poses.size(), std::ref(task));
+    }
+    else
+    {
+        task(0, 0, poses.size());
+    }
+}
+
+void RigidBodyRenderer::RenderPart(size_t part_index,
+                                   const Affine& pose,
+                                   const Matrix& camera_matrix,
+                                   int n_rows,
+                                   int n_cols,
+                                   RenderContext& context,
+                                   std::vector<int>& intersect_indices,
+                                   std::vector<float>& depth) const
+{
+    intersect_indices.clear();
+    depth.clear();
+
+    const Matrix R = pose.rotation();
+    const Vector t = pose.translation();
+
+    Rect rect;
+    if ((frustum_culling_ &&
+         !in_frustum(
+             part_index, R, t, camera_matrix, image_rect(n_rows, n_cols))) ||
+        !bounding_rect(part_index, R, t, camera_matrix, n_rows, n_cols, rect))
+    {
+        return;
+    }
+
+    context.buffer.assign(rect.area(), numeric_limits<float>::infinity());
+    render_part(
+        part_index, R, t, camera_matrix, rect, context, context.buffer.data());
+
+    collect(rect, n_cols, context.buffer.data(), intersect_indices, depth);
+}
+
+bool RigidBodyRenderer::bounding_rect(size_t part_index,
+                                      const Matrix& R,
+                                      const Vector& t,
+                                      const Matrix& camera_matrix,
+                                      int n_rows,
+                                      int n_cols,
+                                      Rect& rect) const
+{
+    // vertices behind the camera are skipped since all triangles containing
+    // them are discarded by the rasterizers
+    double min_x = numeric_limits<double>::max();
+    double max_x = -numeric_limits<double>::max();
+    double min_y = numeric_limits<double>::max();
+    double max_y = -numeric_limits<double>::max();
+    const size_t mesh_index = select_mesh(part_index, R, t, camera_matrix);
+    for (const Vector3d& vertex : vertices_[mesh_index])
+    {
+        Vector3d trans_vertex = R * vertex + t;
+        if (trans_vertex(2) < 0.001) continue;
+
+        Vector2d image_vertex =
+            (camera_matrix * trans_vertex / trans_vertex(2)).topRows(2);
+        min_x = std::min(min_x, image_vertex(0));
+        max_x = std::max(max_x, image_vertex(0));
+        min_y = std::min(min_y, image_vertex(1));
+        max_y = std::max(max_y, image_vertex(1));
+    }
+
+    // one pixel margin against rounding differences to the rasterizers
+    double min_col = std::max(0., std::floor(min_x));
+    double max_col = std::min(double(n_cols - 1), std::ceil(max_x));
+    double min_row = std::max(0., std::floor(min_y));
+    double max_row = std::min(double(n_rows - 1), std::ceil(max_y));
+
+    if (!(min_col <= max_col && min_row <= max_row)) return false;
+
+    rect.min_col = int(min_col);
+    rect.max_col = int(max_col);
+    rect.min_row = int(min_row);
+    rect.max_row = int(max_row);
+
+    return true;
+}
+
+bool RigidBodyRenderer::bounding_rect(const std::vector<Matrix>& R,
+                                      const std::vector<Vector>& t,
+                                      const Matrix& camera_matrix,
+                                      int n_rows,
+                                      int n_cols,
+                                      Rect& rect) const
+{
+    bool visible = false;
+    for (size_t part_index = 0; part_index < part_count_; part_index++)
+    {
+        Rect part_rect;
+        if (!bounding_rect(part_index,
+                           R[part_index],
+                           t[part_index],
+                           camera_matrix,
+                           n_rows,
+                           n_cols,
+                           part_rect))
+        {
+            continue;
+        }
+
+        if (!visible)
+        {
+            rect = part_rect;
+            visible = true;
+            continue;
+        }
+
+        rect.min_row = std::min(rect.min_row, part_rect.min_row);
+        rect.max_row = std::max(rect.max_row, part_rect.max_row);
+        rect.min_col = std::min(rect.min_col, part_rect.min_col);
+        rect.max_col = std::max(rect.max_col, part_rect.max_col);
+    }
+
+    return visible;
+}
+
+bool RigidBodyRenderer::in_frustum(size_t part_index,
+                                   const Matrix& R,
+                                   const Vector& t,
+                                   const Matrix& camera_matrix,
+                                   const Rect& region) const
+{
+    const Vector3d center = R * centers_[part_index] + t;
+    const double radius = radii_[part_index];
+
+    // near plane of the rasterizers
+    if (center(2) + radius < 0.001) return false;
+
+    // a point p projects to image column x = k0.dot(p) / k2.dot(p), the side
+    // planes of the frustum therefore pass through the camera center. The
+    // region is extended by one pixel as in bounding_rect().
+    const Vector3d k0 = camera_matrix.row(0);
+    const Vector3d k1 = camera_matrix.row(1);
+    const Vector3d k2 = camera_matrix.row(2);
+    const Vector3d planes[4] = {k0 - (region.min_col - 1) * k2,
+                                (region.max_col + 1) * k2 - k0,
+                                k1 - (region.min_row - 1) * k2,
+                                (region.max_row + 1) * k2 - k1};
+
+    for (const Vector3d& plane : planes)
+    {
+        if (plane.dot(center) < -radius * plane.norm()) return false;
+    }
+
+    return true;
+}
+
+auto RigidBodyRenderer::image_rect(int n_rows, int n_cols) -> Rect
+{
+    Rect rect;
+    rect.min_row = 0;
+    rect.max_row = n_rows - 1;
+    rect.min_col = 0;
+    rect.max_col = n_cols - 1;
+    return rect;
+}
+
+void RigidBodyRenderer::collect(const Rect& rect,
+                                int n_cols,
+                                const float* buffer,
+                                std::vector<int>& intersect_indices,
+                                std::vector<float>& depth)
+{
+    for (int row = rect.min_row; row <= rect.max_row; row++)
+    {
+        const float* buffer_row = buffer + (row - rect.min_row) * rect.cols();
+        for (int col = rect.min_col; col <= rect.max_col; col++)
+        {
+            float value = buffer_row[col - rect.min_col];
+            if (value != numeric_limits<float>::infinity())
+            {
+                intersect_indices.push_back(row * n_cols + col);
+                depth.push_back(value);
+            }
+        }
+    }
+}
+
+void RigidBodyRenderer::render(const std::vector<Matrix>& R,
+                               const std::vector<Vector>& t,
+                               const Matrix& camera_matrix,
+                               const Rect& viewport,
+                               RenderContext& context,
+                               float* buffer) const
+{
+    for (size_t part_index = 0; part_index < part_count_; part_index++)
+    {
+        render_part(part_index,
+                    R[part_index],
+                    t[part_index],
+                    camera_matrix,
+                    viewport,
+                    context,
+                    buffer);
+    }
+}
+
+void RigidBodyRenderer::render_part(size_t part_index,
+                                    const Matrix& R,
+                                    const Vector& t,
+                                    const Matrix& camera_matrix,
+                                    const Rect& viewport,
+                                    RenderContext& context,
+                                    float* buffer) const
+{
+    if (frustum_culling_ &&
+        !in_frustum(part_index, R, t, camera_matrix, viewport))
+    {
+        return;
+    }
+
+    const size_t mesh_index = select_mesh(part_index, R, t, camera_matrix);
+
+    switch (rasterizer_)
+    {
+        case Rasterizer::Reference:
+            render_part_reference(
+                mesh_index, R, t, camera_matrix, viewport, context, buffer);
+            break;
+        case Rasterizer::Tiled:
+            if (precision_ == Precision::Single)
+            {
+                render_part_tiled_single(
+                    mesh_index, R, t, camera_matrix, viewport, context, buffer);
+            }
+            else
+            {
+                render_part_tiled(
+                    mesh_index, R, t, camera_matrix, viewport, context, buffer);
+            }
+            break;
+    }
+}
+
+size_t RigidBodyRenderer::select_mesh(size_t part_index,
+                                      const Matrix& R,
+                                      const Vector& t,
+                                      const Matrix& camera_matrix) const
+{
+    const vector<size_t>& levels = levels_[part_index];
+    if (levels.size() == 1) return part_index;
+
+    // area of the projected bounding sphere in pixels
+    const double depth = (R * centers_[part_index] + t)(2);
+    if (depth <= radii_[part_index]) return levels.front();
+
+    const double focal_length =
+        std::sqrt(std::fabs(camera_matrix(0, 0) * camera_matrix(1, 1)));
+    const double radius = focal_length * radii_[part_index] / depth;
+    const double area = M_PI * radius * radius;
+
+    // about half of the triangles of a closed mesh face the camera
+    const double max_triangles = 2. * area / lod_pixels_per_triangle_;
+
+    for (size_t mesh_index : levels)
+    {
+        if (indices_[mesh_index].size() <= max_triangles) return mesh_index;
+    }
+    return levels.back();
+}
+
+// todo: does not handle the case properly when the depth is around zero or
+// negative
+void RigidBodyRenderer::render_part_reference(size_t mesh_index,
+                                              const Matrix& R,
+                                              const Vector& t,
+                                              const Matrix& camera_matrix,
+                                              const Rect& viewport,
+                                              RenderContext& context,
+                                              float* buffer) const
 {
     Matrix3d inv_camera_matrix = camera_matrix.inverse();
+    const RayTable* pixel_rays = rays(camera_matrix, viewport);
 
     // we project all the points into image space
     // --------------------------------------------------------
-    vector<vector<Vector3d>> trans_vertices(vertices_.size());
-    vector<vector<Vector2d>> image_vertices(vertices_.size());
+    const vector<Vector3d>& part_vertices = vertices_[mesh_index];
+    vector<Vector3d>& trans_vertices = context.trans_vertices;
+    vector<Vector2d>& image_vertices = context.image_vertices;
+    trans_vertices.resize(part_vertices.size());
+    image_vertices.resize(part_vertices.size());
 
-    for (int part_index = 0; part_index < int(vertices_.size()); part_index++)
+    for (size_t point_index = 0; point_index < part_vertices.size();
+         point_index++)
     {
-        image_vertices[part_index].resize(vertices_[part_index].size());
-        trans_vertices[part_index].resize(vertices_[part_index].size());
-        for (int point_index = 0;
-             point_index < int(vertices_[part_index].size());
-             point_index++)
-        {
-            trans_vertices[part_index][point_index] =
-                R_[part_index] * vertices_[part_index][point_index] +
-                t_[part_index];
-            image_vertices[part_index][point_index] =
-                (camera_matrix * trans_vertices[part_index][point_index] /
-                 trans_vertices[part_index][point_index](2))
-                    .topRows(2);
-        }
+        trans_vertices[point_index] = R * part_vertices[point_index] + t;
+        image_vertices[point_index] =
+            (camera_matrix * trans_vertices[point_index] /
+             trans_vertices[point_index](2))
+                .topRows(2);
     }
 
     // we find the intersections with the triangles and the depths
     // ---------------------------------------------------
-    depth_image =
-        vector<float>(n_rows * n_cols, numeric_limits<float>::infinity());
+    for (size_t triangle_index = 0;
+         triangle_index < indices_[mesh_index].size();
+         triangle_index++)
+    {
+        const vector<int>& triangle = indices_[mesh_index][triangle_index];
 
-    for (int part_index = 0; part_index < int(indices_.size()); part_index++)
+        // how should this be handled properly? for now if some vertex
+        // in a triangle comes to lie behind camera
+        // we just discard that triangle.
+        Vector2d vertices[3];
+        bool behind_camera = false;
+        for (int i = 0; i < 3; i++)
+        {
+            vertices[i] = image_vertices[triangle[i]];
+            if (trans_vertices[triangle[i]](2) < 0.001) behind_camera = true;
+        }
+        if (behind_camera) continue;
+
+        Vector3d normal = R * normals_[mesh_index][triangle_index];
+        float offset = normal.dot(trans_vertices[triangle[0]]);
+
+        // the outward normal of a visible triangle points to the camera
+        if (back_face_culling_ && orientations_[mesh_index] * offset > 0)
+        {
+            continue;
+        }
+
+        render_triangle(vertices,
+                        normal,
+                        offset,
+                        inv_camera_matrix,
+                        pixel_rays,
+                        viewport,
+                        buffer);
+    }
+}
+
+void RigidBodyRenderer::render_part_tiled(size_t mesh_index,
+                                          const Matrix& R,
+                                          const Vector& t,
+                                          const Matrix& camera_matrix,
+                                          const Rect& viewport,
+                                          RenderContext& context,
+                                          float* buffer) const
+{
+    Matrix3d inv_camera_matrix = camera_matrix.inverse();
+    Matrix3d inv_camera_matrix_t = inv_camera_matrix.transpose();
+
+    TileRasterizer rasterizer(viewport.rows(),
+                              viewport.cols(),
+                              buffer,
+                              viewport.min_row,
+                              viewport.min_col);
+
+    const vector<Vector3d>& part_vertices = vertices_[mesh_index];
+    vector<Vector3d>& trans_vertices = context.trans_vertices;
+    vector<Vector2d>& image_vertices = context.image_vertices;
+    trans_vertices.resize(part_vertices.size());
+    image_vertices.resize(part_vertices.size());
+
+    for (size_t i = 0; i < part_vertices.size(); i++)
     {
-        for (int triangle_index = 0;
-             triangle_index < int(indices_[part_index].size());
-             triangle_index++)
+        trans_vertices[i] = R * part_vertices[i] + t;
+        image_vertices[i] =
+            (camera_matrix * trans_vertices[i] / trans_vertices[i](2))
+                .topRows(2);
+    }
+
+    for (size_t triangle_index = 0;
+         triangle_index < indices_[mesh_index].size();
+         triangle_index++)
+    {
+        const vector<int>& triangle = indices_[mesh_index][triangle_index];
+
+        Vector2d vertices[3];
+        bool behind_camera = false;
+        for (int i = 0; i < 3; i++)
+        {
+            vertices[i] = image_vertices[triangle[i]];
+            if (trans_vertices[triangle[i]](2) < 0.001) behind_camera = true;
+        }
+        if (behind_camera) continue;
+
+        // the inverse depth of the pixel ray K^-1 (col, row, 1) hitting
+        // the plane normal.dot(x) = offset is linear in col and row
+        Vector3d normal = R * normals_[mesh_index][triangle_index];
+        double offset = normal.dot(trans_vertices[triangle[0]]);
+        if (back_face_culling_ && orientations_[mesh_index] * offset > 0)
+        {
+            continue;
+        }
+
+        Vector3d inv_depth_plane = inv_camera_matrix_t * normal / offset;
+
+        // the corners of the triangle are stored contiguously
+        if (!rasterizer.draw(vertices[0].data(), inv_depth_plane.data()))
+        {
+            render_triangle(vertices,
+                            normal,
+                            offset,
+                            inv_camera_matrix,
+                            rays(camera_matrix, viewport),
+                            viewport,
+                            buffer);
+        }
+    }
+}
+
+void RigidBodyRenderer::render_part_tiled_single(size_t mesh_index,
+                                                 const Matrix& R,
+                                                 const Vector& t,
+                                                 const Matrix& camera_matrix,
+                                                 const Rect& viewport,
+                                                 RenderContext& context,
+                                                 float* buffer) const
+{
+    typedef Map<const ArrayXf> ConstArrayMap;
+    typedef Map<ArrayXf> ArrayMap;
+
+    const Matrix3f Rf = R.cast<float>();
+    const Vector3f tf = t.cast<float>();
+    const Matrix3f K = camera_matrix.cast<float>();
+    const Matrix3d inv_camera_matrix = camera_matrix.inverse();
+    const Matrix3f inv_camera_matrix_t =
+        inv_camera_matrix.transpose().cast<float>();
+
+    // transform and project all vertices. The packed arrays allow Eigen to
+    // vectorize the vertex stage across vertices.
+    const vector<float>& packed_vertices = packed_vertices_[mesh_index];
+    const int n = packed_vertices.size() / 3;
+    context.packed_vertices.resize(5 * n);
+    float* v = context.packed_vertices.data();
+
+    ConstArrayMap x(packed_vertices.data(), n);
+    ConstArrayMap y(packed_vertices.data() + n, n);
+    ConstArrayMap z(packed_vertices.data() + 2 * n, n);
+    ArrayMap trans_x(v, n);
+    ArrayMap trans_y(v + n, n);
+    ArrayMap trans_z(v + 2 * n, n);
+    ArrayMap image_col(v + 3 * n, n);
+    ArrayMap image_row(v + 4 * n, n);
+
+    trans_x = Rf(0, 0) * x + Rf(0, 1) * y + Rf(0, 2) * z + tf(0);
+    trans_y = Rf(1, 0) * x + Rf(1, 1) * y + Rf(1, 2) * z + tf(1);
+    trans_z = Rf(2, 0) * x + Rf(2, 1) * y + Rf(2, 2) * z + tf(2);
+    image_col = (K(0, 0) * trans_x + K(0, 1) * trans_y + K(0, 2) * trans_z) /
+                trans_z;
+    image_row = (K(1, 0) * trans_x + K(1, 1) * trans_y + K(1, 2) * trans_z) /
+                trans_z;
+
+    // rotate all normals. The plane offset follows from the model offset,
+    // (R * n).dot(R * vertex + t) = n.dot(vertex) + (R * n).dot(t).
+    const vector<float>& packed_normals = packed_normals_[mesh_index];
+    const int m = packed_normals.size() / 4;
+    context.packed_normals.resize(4 * m);
+    float* nv = context.packed_normals.data();
+
+    ConstArrayMap normal_x(packed_normals.data(), m);
+    ConstArrayMap normal_y(packed_normals.data() + m, m);
+    ConstArrayMap normal_z(packed_normals.data() + 2 * m, m);
+    ConstArrayMap model_offset(packed_normals.data() + 3 * m, m);
+    ArrayMap trans_normal_x(nv, m);
+    ArrayMap trans_normal_y(nv + m, m);
+    ArrayMap trans_normal_z(nv + 2 * m, m);
+    ArrayMap offset(nv + 3 * m, m);
+
+    trans_normal_x =
+        Rf(0, 0) * normal_x + Rf(0, 1) * normal_y + Rf(0, 2) * normal_z;
+    trans_normal_y =
+        Rf(1, 0) * normal_x + Rf(1, 1) * normal_y + Rf(1, 2) * normal_z;
+    trans_normal_z =
+        Rf(2, 0) * normal_x + Rf(2, 1) * normal_y + Rf(2, 2) * normal_z;
+    offset = model_offset + tf(0) * trans_normal_x + tf(1) * trans_normal_y +
+             tf(2) * trans_normal_z;
+
+    // rasterize ---------------------------------------------------------------
+    TileRasterizer rasterizer(viewport.rows(),
+                              viewport.cols(),
+                              buffer,
+                              viewport.min_row,
+                              viewport.min_col);
+
+    for (int triangle_index = 0; triangle_index < m; triangle_index++)
+    {
+        const vector<int>& triangle = indices_[mesh_index][triangle_index];
+
+        Vector2d vertices[3];
+        bool behind_camera = false;
+        for (int i = 0; i < 3; i++)
+        {
+            vertices[i] =
+                Vector2d(image_col[triangle[i]], image_row[triangle[i]]);
+            if (trans_z[triangle[i]] < 0.001f) behind_camera = true;
+        }
+        if (behind_camera) continue;
+
+        const float triangle_offset = offset[triangle_index];
+        if (back_face_culling_ &&
+            orientations_[mesh_index] * triangle_offset > 0)
         {
-            vector<Vector2d> vertices(3);
-            Vector2d center(Vector2d::Zero());
-
-            // find the min and max indices to be checked
-            // ------------------------------------------------------------
-            int min_row = numeric_limits<int>::max();
-            int max_row = -numeric_limits<int>::max();
-            int min_col = numeric_limits<int>::max();
-            int max_col = -numeric_limits<int>::max();
-            bool behind_camera = false;
-            for (int i = 0; i < 3; i++)
+            continue;
+        }
+
+        Vector3f normal(trans_normal_x[triangle_index],
+                        trans_normal_y[triangle_index],
+                        trans_normal_z[triangle_index]);
+        Vector3d inv_depth_plane =
+            (inv_camera_matrix_t * normal / triangle_offset).cast<double>();
+
+        if (!rasterizer.draw(vertices[0].data(), inv_depth_plane.data()))
+        {
+            render_triangle(vertices,
+                            normal.cast<double>(),
+                            triangle_offset,
+                            inv_camera_matrix,
+                            rays(camera_matrix, viewport),
+                            viewport,
+                            buffer);
+        }
+    }
+}
+
+void RigidBodyRenderer::render_triangle(const Vector2d* vertices,
+                                        const Vector& normal,
+                                        float offset,
+                                        const Matrix& inv_camera_matrix,
+                                        const RayTable* rays,
+                                        const Rect& viewport,
+                                        float* buffer) const
+{
+    Vector2d center(Vector2d::Zero());
+
+    // find the min and max indices to be checked
+    // ------------------------------------------------------------
+    int min_row = numeric_limits<int>::max();
+    int max_row = -numeric_limits<int>::max();
+    int min_col = numeric_limits<int>::max();
+    int max_col = -numeric_limits<int>::max();
+    for (int i = 0; i < 3; i++)
+    {
+        center += vertices[i] / 3.;
+        min_row = ceil(float(vertices[i](1))) < min_row
+                      ? ceil(float(vertices[i](1)))
+                      : min_row;
+        max_row = floor(float(vertices[i](1))) > max_row
+                      ? floor(float(vertices[i](1)))
+                      : max_row;
+        min_col = ceil(float(vertices[i](0))) < min_col
+                      ? ceil(float(vertices[i](0)))
+                      : min_col;
+        max_col = floor(float(vertices[i](0))) > max_col
+                      ? floor(float(vertices[i](0)))
+                      : max_col;
+    }
+
+    // make sure all of them are inside of the viewport
+    // -----------------------------------------------------------------
+    min_row = min_row >= viewport.min_row ? min_row : viewport.min_row;
+    max_row = max_row <= viewport.max_row ? max_row : viewport.max_row;
+    min_col = min_col >= viewport.min_col ? min_col : viewport.min_col;
+    max_col = max_col <= viewport.max_col ? max_col : viewport.max_col;
+
+    // check whether triangle is inside the viewport
+    // ----------------------------------------------------------------------
+    if (max_row < min_row || max_col < min_col) return;
+
+    const int stride = viewport.cols();
+    const float nx = normal(0);
+    const float ny = normal(1);
+    const float nz = normal(2);
+
+    // we find the line params of the triangle sides
+    // ---------------------------------------------------------------
+    float slopes[3];
+    bool boundary_type[3];
+    const bool upper = true;
+    const bool lower = false;
+
+    for (int i = 0; i < 3; i++)
+    {
+        Vector2d side = vertices[(i + 1) % 3] - vertices[i];
+        slopes[i] = side(1) / side(0);
+
+        // we determine whether the line limits the triangle on top or
+        // on the bottom
+        if (vertices[i](1) + slopes[i] * (center(0) - vertices[i](0)) >
+            center(1))
+            boundary_type[i] = upper;
+        else
+            boundary_type[i] = lower;
+    }
+
+    if (boundary_type[0] == boundary_type[1] &&
+        boundary_type[0] ==
+            boundary_type[2])  // if triangle is degenerate we continue
+        return;
+
+    for (int col = min_col; col <= max_col; col++)
+    {
+        float min_row_given_col = -numeric_limits<float>::max();
+        float max_row_given_col = numeric_limits<float>::max();
+
+        // the min_row is the max lower boundary at that column, and the
+        // max_row is the min upper boundary at that column
+        for (int i = 0; i < 3; i++)
+        {
+            if (boundary_type[i] == lower)
             {
-                vertices[i] =
-                    image_vertices[part_index]
-                                  [indices_[part_index][triangle_index][i]];
-                center += vertices[i] / 3.;
-                min_row = ceil(float(vertices[i](1))) < min_row
-                              ? ceil(float(vertices[i](1)))
-                              : min_row;
-                max_row = floor(float(vertices[i](1))) > max_row
-                              ? floor(float(vertices[i](1)))
-                              : max_row;
-                min_col = ceil(float(vertices[i](0))) < min_col
-                              ? ceil(float(vertices[i](0)))
-                              : min_col;
-                max_col = floor(float(vertices[i](0))) > max_col
-                              ? floor(float(vertices[i](0)))
-                              : max_col;
-
-                // how should this be handled properly? for now if some vertex
-                // in a triangle comes to lie behind camera
-                // we just discard that triangle.
-                if (trans_vertices[part_index]
-                                  [indices_[part_index][triangle_index][i]](2) <
-                    0.001)
-                    behind_camera = true;
+                float lowe_Rboundary =
+                    ceil(float(vertices[i](1) +
+                               slopes[i] * (float(col) - vertices[i](0))));
+                min_row_given_col = lowe_Rboundary > min_row_given_col
+                                        ? lowe_Rboundary
+                                        : min_row_given_col;
             }
-            if (behind_camera) continue;
-
-            // make sure all of them are inside of image
-            // -----------------------------------------------------------------
-            min_row = min_row >= 0 ? min_row : 0;
-            max_row = max_row < n_rows ? max_row : (n_rows - 1);
-            min_col = min_col >= 0 ? min_col : 0;
-            max_col = max_col < n_cols ? max_col : (n_cols - 1);
-
-            // check whether triangle is inside image
-            // ----------------------------------------------------------------------
-            if (max_row < 0 || min_row >= n_rows || max_col < 0 ||
-                min_col >= n_cols || max_row < min_row || max_col < min_col)
-                continue;
-
-            // we find the line params of the triangle sides
-            // ---------------------------------------------------------------
-            vector<float> slopes(3);
-            vector<bool> boundary_type(3);
-            const bool upper = true;
-            const bool lower = false;
-
-            for (int i = 0; i < 3; i++)
+            else
             {
-                Vector2d side = vertices[(i + 1) % 3] - vertices[i];
-                slopes[i] = side(1) / side(0);
-
-                // we determine whether the line limits the triangle on top or
-                // on the bottom
-                if (vertices[i](1) + slopes[i] * (center(0) - vertices[i](0)) >
-                    center(1))
-                    boundary_type[i] = upper;
-                else
-                    boundary_type[i] = lower;
+                float upper_boundary =
+                    floor(float(vertices[i](1) +
+                                slopes[i] * (float(col) - vertices[i](0))));
+                max_row_given_col = upper_boundary < max_row_given_col
+                                        ? upper_boundary
+                                        : max_row_given_col;
             }
+        }
+
+        const int begin_row =
+            int(std::max(min_row_given_col, float(viewport.min_row)));
+        const int end_row =
+            int(std::min(max_row_given_col, float(viewport.max_row)));
+        float* column = buffer + (col - viewport.min_col);
 
-            if (boundary_type[0] == boundary_type[1] &&
-                boundary_type[0] ==
-                    boundary_type[2])  // if triangle is degenerate we continue
-                continue;
+        // we push back the indices of the intersections and the
+        // corresponding depths ------------------------------------
+        if (rays)
+        {
+            // the depth is offset / normal.dot(ray) with the rays of this
+            // column stored contiguously
+            const size_t first = size_t(col) * rays->n_rows;
+            const float* ray_x = rays->x.data() + first;
+            const float* ray_y = rays->y.data() + first;
+            const float* ray_z = rays->z.data() + first;
 
-            for (int col = min_col; col <= max_col; col++)
+            for (int row = begin_row; row <= end_row; row++)
             {
-                float min_row_given_col = -numeric_limits<float>::max();
-                float max_row_given_col = numeric_limits<float>::max();
-
-                // the min_row is the max lower boundary at that column, and the
-                // max_row is the min upper boundary at that column
-                for (int i = 0; i < 3; i++)
-                {
-                    if (boundary_type[i] == lower)
-                    {
-                        float lowe_Rboundary = ceil(
-                            float(vertices[i](1) +
-                                  slopes[i] * (float(col) - vertices[i](0))));
-                        min_row_given_col = lowe_Rboundary > min_row_given_col
-                                                ? lowe_Rboundary
-                                                : min_row_given_col;
-                    }
-                    else
-                    {
-                        float upper_boundary = floor(
-                            float(vertices[i](1) +
-                                  slopes[i] * (float(col) - vertices[i](0))));
-                        max_row_given_col = upper_boundary < max_row_given_col
-                                                ? upper_boundary
-                                                : max_row_given_col;
-                    }
-                }
-
-                // we push back the indices of the intersections and the
-                // corresponding depths ------------------------------------
-                Vector3d normal =
-                    R_[part_index] * normals_[part_index][triangle_index];
-                float offset = normal.dot(
-                    trans_vertices[part_index]
-                                  [indices_[part_index][triangle_index][0]]);
-                for (int row = int(min_row_given_col);
-                     row <= int(max_row_given_col);
-                     row++)
-                    if (row >= 0 && row < n_rows && col >= 0 && col < n_cols)
-                    {
-                        //						intersec_tindices.push_back(row*n_cols
-                        //+
-                        // col);
-                        // we find the intersection between the ray and the
-                        // triangle --------------------------------------------
-                        Vector3d line_vector =
-                            inv_camera_matrix *
-                            Vector3d(
-                                col, row, 1);  // the depth is the z component
-                        float depth =
-                            std::fabs(offset / normal.dot(line_vector));
-                        // if(depth > 0.5)
-                        depth_image[row * n_cols + col] =
-                            depth < depth_image[row * n_cols + col]
-                                ? depth
-                                : depth_image[row * n_cols + col];
-                    }
+                float depth = std::fabs(
+                    offset /
+                    (nx * ray_x[row] + ny * ray_y[row] + nz * ray_z[row]));
+                float& pixel = column[(row - viewport.min_row) * stride];
+                pixel = depth < pixel ? depth : pixel;
             }
+            continue;
+        }
+
+        for (int row = begin_row; row <= end_row; row++)
+        {
+            // we find the intersection between the ray and the
+            // triangle --------------------------------------------
+            Vector3d line_vector =
+                inv_camera_matrix *
+                Vector3d(col, row, 1);  // the depth is the z component
+            float depth = std::fabs(offset / normal.dot(line_vector));
+            float& pixel = column[(row - viewport.min_row) * stride];
+            pixel = depth < pixel ? depth : pixel;
         }
     }
 }
@@ -301,31 +961,28 @@ void RigidBodyRenderer::Render(Matrix camera_matrix,
                                std::vector<int>& intersect_indices,
                                std::vector<float>& depth) const
 {
-    vector<float> depth_image;
-
-    Render(camera_matrix, n_rows, n_cols, depth_image);
+    RenderContext context;
+    Render(camera_matrix, n_rows, n_cols, context, intersect_indices, depth);
+}
 
-    // fill the depths into the depth vector -------------------------------
+void RigidBodyRenderer::Render(const Matrix& camera_matrix,
+                               int n_rows,
+                               int n_cols,
+                               RenderContext& context,
+                               std::vector<int>& intersect_indices,
+                               std::vector<float>& depth) const
+{
     intersect_indices.clear();
     depth.clear();
-    intersect_indices.resize(n_rows * n_cols);
-    depth.resize(n_rows * n_cols);
-    int count = 0;
-    for (int row = 0; row < n_rows; row++)
-    {
-        for (int col = 0; col < n_cols; col++)
-        {
-            if (depth_image[row * n_cols + col] !=
-                numeric_limits<float>::infinity())
-            {
-                intersect_indices[count] = row * n_cols + col;
-                depth[count] = depth_image[row * n_cols + col];
-                count++;
-            }
-        }
-    }
-    intersect_indices.resize(count);
-    depth.resize(count);
+
+    // only the region covered by the projected object is rendered ---------
+    Rect rect;
+    if (!bounding_rect(R_, t_, camera_matrix, n_rows, n_cols, rect)) return;
+
+    context.buffer.assign(rect.area(), numeric_limits<float>::infinity());
+    render(R_, t_, camera_matrix, rect, context, context.buffer.data());
+
+    collect(rect, n_cols, context.buffer.data(), intersect_indices, depth);
 }
 
 void RigidBodyRenderer::Render(std::vector<float>& depth_image) const
@@ -340,9 +997,9 @@ void RigidBodyRenderer::Render(std::vector<float>& depth_image) const
 std::vector<std::vector<RigidBodyRenderer::Vector>>
 RigidBodyRenderer::vertices() const
 {
-    vector<vector<Vector3d>> trans_vertices(vertices_.size());
+    vector<vector<Vector3d>> trans_vertices(part_count_);
 
-    for (int o = 0; o < int(vertices_.size()); o++)
+    for (int o = 0; o < int(part_count_); o++)
     {
         trans_vertices[o].resize(vertices_[o].size());
         for (int p = 0; p < int(vertices_[o].size()); p++)
@@ -376,6 +1033,148 @@ void RigidBodyRenderer::parameters(Matrix camera_matrix, int n_rows, int n_cols)
     camera_matrix_ = camera_matrix;
     n_rows_ = n_rows;
     n_cols_ = n_cols;
+
+    update_rays();
+}
+
+void RigidBodyRenderer::update_rays()
+{
+    rays_.camera_matrix = camera_matrix_;
+    rays_.n_rows = 0;
+    rays_.n_cols = 0;
+    rays_.x.clear();
+    rays_.y.clear();
+    rays_.z.clear();
+
+    if (n_rows_ <= 0 || n_cols_ <= 0 || camera_matrix_.determinant() == 0)
+    {
+        return;
+    }
+
+    const Matrix inv_camera_matrix = camera_matrix_.inverse();
+    const size_t pixel_count = size_t(n_rows_) * n_cols_;
+    rays_.x.resize(pixel_count);
+    rays_.y.resize(pixel_count);
+    rays_.z.resize(pixel_count);
+
+    size_t i = 0;
+    for (int col = 0; col < n_cols_; col++)
+    {
+        for (int row = 0; row < n_rows_; row++, i++)
+        {
+            Vector ray = inv_camera_matrix * Vector(col, row, 1);
+            rays_.x[i] = ray(0);
+            rays_.y[i] = ray(1);
+            rays_.z[i] = ray(2);
+        }
+    }
+
+    rays_.n_rows = n_rows_;
+    rays_.n_cols = n_cols_;
+}
+
+auto RigidBodyRenderer::rays(const Matrix& camera_matrix,
+                             const Rect& viewport) const -> const RayTable*
+{
+    if (viewport.min_row < 0 || viewport.max_row >= rays_.n_rows ||
+        viewport.min_col < 0 || viewport.max_col >= rays_.n_cols ||
+        camera_matrix != rays_.camera_matrix)
+    {
+        return nullptr;
+    }
+
+    return &rays_;
+}
+
+void RigidBodyRenderer::rasterizer(Rasterizer rasterizer)
+{
+    rasterizer_ = rasterizer;
+    revision_++;
+}
+
+auto RigidBodyRenderer::rasterizer() const -> Rasterizer
+{
+    return rasterizer_;
+}
+
+void RigidBodyRenderer::add_level_of_detail(
+    const std::vector<std::vector<Eigen::Vector3d>>& vertices,
+    const std::vector<std::vector<std::vector<int>>>& indices)
+{
+    if (vertices.size() != part_count_ || indices.size() != part_count_)
+    {
+        cout << "error, a level of detail has to contain all " << part_count_
+             << " parts" << endl;
+        exit(-1);
+    }
+
+    for (size_t part_index = 0; part_index < part_count_; part_index++)
+    {
+        levels_[part_index].push_back(vertices_.size());
+        vertices_.push_back(vertices[part_index]);
+        indices_.push_back(indices[part_index]);
+    }
+
+    update_meshes();
+    revision_++;
+}
+
+void RigidBodyRenderer::lod_pixels_per_triangle(double pixels)
+{
+    lod_pixels_per_triangle_ = pixels;
+    revision_++;
+}
+
+double RigidBodyRenderer::lod_pixels_per_triangle() const
+{
+    return lod_pixels_per_triangle_;
+}
+
+void RigidBodyRenderer::precision(Precision precision)
+{
+    precision_ = precision;
+    revision_++;
+}
+
+auto RigidBodyRenderer::precision() const -> Precision
+{
+    return precision_;
+}
+
+void RigidBodyRenderer::back_face_culling(bool enabled)
+{
+    back_face_culling_ = enabled;
+    revision_++;
+}
+
+bool RigidBodyRenderer::back_face_culling() const
+{
+    return back_face_culling_;
+}
+
+void RigidBodyRenderer::frustum_culling(bool enabled)
+{
+    frustum_culling_ = enabled;
+}
+
+bool RigidBodyRenderer::frustum_culling() const
+{
+    return frustum_culling_;
+}
+
+void RigidBodyRenderer::executor(const std::shared_ptr<Executor>& executor)
+{
+    executor_ = executor;
+}
+
+const std::shared_ptr<Executor>& RigidBodyRenderer::executor() const
+{
+    return executor_;
+}
+
+size_t RigidBodyRenderer::revision() const
+{
+    return revision_;
 }
 
 // test the enchilada
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <dbot/executor.h>
 #include <dbot/pose/rigid_bodies_state.h>
 #include <memory>
 #include <vector>
@@ -29,6 +30,85 @@ public:
     typedef Eigen::Matrix3d Matrix;
     typedef typename Eigen::Transform<double, 3, Eigen::Affine> Affine;
 
+    /**
+     * \brief Inclusive pixel rectangle
+     */
+    struct Rect
+    {
+        int min_row;
+        int max_row;
+        int min_col;
+        int max_col;
+
+        int rows() const { return max_row - min_row + 1; }
+        int cols() const { return max_col - min_col + 1; }
+        int area() const { return rows() * cols(); }
+    };
+
+    /**
+     * \brief Work buffers of the render functions
+     *
+     * The buffers only grow until they fit the model and the rendered region,
+     * hence reusing a context across calls avoids all heap allocations in the
+     * steady state. A context must not be used by concurrent calls.
+     */
+    struct RenderContext
+    {
+        std::vector<Vector> trans_vertices;
+        std::vector<Eigen::Vector2d> image_vertices;
+        std::vector<float> buffer;
+
+        // single precision vertex and normal stage, see Precision
+        std::vector<float> packed_vertices;
+        std::vector<float> packed_normals;
+    };
+
+    /**
+     * \brief Work buffers of RenderBatch, one RenderContext and pose buffer
+     *        per executor chunk
+     *
+     * Like a RenderContext, a batch context avoids all heap allocations once
+     * it has grown to the executor and the model, and must not be used by
+     * concurrent calls.
+     */
+    struct BatchContext
+    {
+        struct Chunk
+        {
+            RenderContext context;
+            std::vector<Matrix> R;
+            std::vector<Vector> t;
+        };
+
+        std::vector<Chunk> chunks;
+    };
+
+    /**
+     * \brief Rasterizer backends
+     *
+     * Reference is the original column scan implementation and is kept to
+     * validate the output of the Tiled edge function rasterizer.
+     */
+    enum class Rasterizer
+    {
+        Reference,
+        Tiled
+    };
+
+    /**
+     * \brief Arithmetic of the vertex stage of the Tiled rasterizer
+     *
+     * Single transforms and projects packed float copies of the vertices and
+     * normals (x, y and z stored in separate arrays). Double is the original
+     * vertex stage and is kept for validation. The Reference rasterizer
+     * always uses Double.
+     */
+    enum class Precision
+    {
+        Double,
+        Single
+    };
+
     RigidBodyRenderer(
         const std::vector<std::vector<Eigen::Vector3d>>& vertices,
         const std::vector<std::vector<std::vector<int>>>& indices);
@@ -41,12 +121,31 @@ public:
 
     virtual ~RigidBodyRenderer();
 
+    /**
+     * \brief Renders the object and returns the indices of the hit pixels in
+     *        ascending order together with their depths
+     *
+     * Only the bounding rectangle of the projected parts is rasterized, such
+     * that the cost does not depend on the image resolution but on the area
+     * covered by the object.
+     */
     void Render(Matrix camera_matrix,
                 int n_rows,
                 int n_cols,
                 std::vector<int>& intersect_indices,
                 std::vector<float>& depth) const;
 
+    /**
+     * \brief Same as above using the buffers of \a context. The output vectors
+     *        are cleared but keep their capacity.
+     */
+    void Render(const Matrix& camera_matrix,
+                int n_rows,
+                int n_cols,
+                RenderContext& context,
+                std::vector<int>& intersect_indices,
+                std::vector<float>& depth) const;
+
     void Render(Matrix camera_matrix,
                 int n_rows,
                 int n_cols,
@@ -54,6 +153,47 @@ public:
 
     void Render(std::vector<float>& depth_image) const;
 
+    /**
+     * \brief Renders the object once for each set of part poses into a single
+     *        depth atlas
+     *
+     * The depth image of pose set i is stored at offset i * n_rows * n_cols.
+     * The atlas is only reallocated if its size changes. The pose sets are
+     * distributed over the executor. This function neither uses nor changes
+     * the poses passed to set_poses(), hence concurrent calls are safe.
+     */
+    void RenderBatch(const std::vector<std::vector<Affine>>& poses,
+                     const Matrix& camera_matrix,
+                     int n_rows,
+                     int n_cols,
+                     std::vector<float>& depth_atlas) const;
+
+    /**
+     * \brief Same as above using the buffers of \a context, each executor
+     *        chunk renders with its own entry
+     */
+    void RenderBatch(const std::vector<std::vector<Affine>>& poses,
+                     const Matrix& camera_matrix,
+                     int n_rows,
+                     int n_cols,
+                     BatchContext& context,
+                     std::vector<float>& depth_atlas) const;
+
+    /**
+     * \brief Renders a single part with the given pose and returns the hit
+     *        pixel indices and their depths
+     *
+     * Like RenderBatch, this function does not depend on set_poses().
+     */
+    void RenderPart(size_t part_index,
+                    const Affine& pose,
+                    const Matrix& camera_matrix,
+                    int n_rows,
+                    int n_cols,
+                    RenderContext& context,
+                    std::vector<int>& intersect_indices,
+                    std::vector<float>& depth) const;
+
     template <typename RigidbodyState>
     void Render(const RigidbodyState& state, std::vector<float>& depth_vector)
 
@@ -126,23 +266,238 @@ public:
 
     void parameters(Matrix camera_matrix, int n_rows, int n_cols);
 
+    void rasterizer(Rasterizer rasterizer);
+    Rasterizer rasterizer() const;
+
+    void precision(Precision precision);
+    Precision precision() const;
+
+    /**
+     * \brief Adds a coarser version of all parts. Levels have to be added from
+     *        fine to coarse.
+     *
+     * Each part is rendered with the finest level whose triangles cover
+     * lod_pixels_per_triangle() pixels on average, estimated from the
+     * projected bounding sphere of the part. If even the coarsest level is
+     * too fine, the coarsest level is used.
+     */
+    void add_level_of_detail(
+        const std::vector<std::vector<Eigen::Vector3d>>& vertices,
+        const std::vector<std::vector<std::vector<int>>>& indices);
+
+    void lod_pixels_per_triangle(double pixels);
+    double lod_pixels_per_triangle() const;
+
+    /**
+     * \brief Skips triangles facing away from the camera. The orientation of
+     *        each part is derived from its signed volume, hence this is only
+     *        valid for closed meshes. Disabled by default.
+     */
+    void back_face_culling(bool enabled);
+    bool back_face_culling() const;
+
+    /**
+     * \brief Skips parts whose bounding sphere lies outside of the rendered
+     *        region. Enabled by default.
+     */
+    void frustum_culling(bool enabled);
+    bool frustum_culling() const;
+
+    void executor(const std::shared_ptr<Executor>& executor);
+    const std::shared_ptr<Executor>& executor() const;
+
+    /**
+     * \brief Changes whenever the meshes or a setting that may change the
+     *        rendered depth change, e.g. to invalidate cached renderings
+     */
+    size_t revision() const;
+
 private:
+    /**
+     * \brief Viewing rays inv(camera_matrix) * (col, row, 1) of all pixels of
+     *        an image, stored as x, y and z arrays in column-major order to
+     *        match the column scan of render_triangle()
+     */
+    struct RayTable
+    {
+        Matrix camera_matrix;
+        int n_rows;
+        int n_cols;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+    };
+
     /**
      * Because c++0x on gcc.4.6 does not implement delegating constructors
      */
     void init();
 
+    /**
+     * \brief Recomputes the ray table for camera_matrix_, n_rows_ and n_cols_
+     */
+    void update_rays();
+
+    /**
+     * \brief Returns the ray table if it has been computed for
+     *        \a camera_matrix and covers \a viewport, otherwise nullptr
+     */
+    const RayTable* rays(const Matrix& camera_matrix,
+                         const Rect& viewport) const;
+
+    /**
+     * \brief Computes normals, bounding spheres and packed copies of all
+     *        meshes
+     */
+    void update_meshes();
+
+    /**
+     * \brief Index of the mesh rendering the part at its level of detail
+     */
+    size_t select_mesh(size_t part_index,
+                       const Matrix& R,
+                       const Vector& t,
+                       const Matrix& camera_matrix) const;
+
+    /**
+     * \brief Renders the parts with the given rotations and translations into
+     *        the buffer which has to be initialized by the caller
+     *
+     * The row-major buffer covers the image region \a viewport. Pixels outside
+     * of the viewport are clipped.
+     */
+    void render(const std::vector<Matrix>& R,
+                const std::vector<Vector>& t,
+                const Matrix& camera_matrix,
+                const Rect& viewport,
+                RenderContext& context,
+                float* buffer) const;
+
+    void render_part(size_t part_index,
+                     const Matrix& R,
+                     const Vector& t,
+                     const Matrix& camera_matrix,
+                     const Rect& viewport,
+                     RenderContext& context,
+                     float* buffer) const;
+
+    void render_part_reference(size_t mesh_index,
+                               const Matrix& R,
+                               const Vector& t,
+                               const Matrix& camera_matrix,
+                               const Rect& viewport,
+                               RenderContext& context,
+                               float* buffer) const;
+
+    void render_part_tiled(size_t mesh_index,
+                           const Matrix& R,
+                           const Vector& t,
+                           const Matrix& camera_matrix,
+                           const Rect& viewport,
+                           RenderContext& context,
+                           float* buffer) const;
+
+    void render_part_tiled_single(size_t mesh_index,
+                                  const Matrix& R,
+                                  const Vector& t,
+                                  const Matrix& camera_matrix,
+                                  const Rect& viewport,
+                                  RenderContext& context,
+                                  float* buffer) const;
+
+    /**
+     * \brief Computes the image rectangle covered by the projection of the
+     *        part. Returns false if the part does not project into the image.
+     */
+    bool bounding_rect(size_t part_index,
+                       const Matrix& R,
+                       const Vector& t,
+                       const Matrix& camera_matrix,
+                       int n_rows,
+                       int n_cols,
+                       Rect& rect) const;
+
+    /**
+     * \brief Union of the bounding rectangles of all parts. Returns false if
+     *        none of the parts projects into the image.
+     */
+    bool bounding_rect(const std::vector<Matrix>& R,
+                       const std::vector<Vector>& t,
+                       const Matrix& camera_matrix,
+                       int n_rows,
+                       int n_cols,
+                       Rect& rect) const;
+
+    static Rect image_rect(int n_rows, int n_cols);
+
+    /**
+     * \brief Tests whether the bounding sphere of the part intersects the
+     *        viewing frustum through the pixel rectangle \a region
+     */
+    bool in_frustum(size_t part_index,
+                    const Matrix& R,
+                    const Vector& t,
+                    const Matrix& camera_matrix,
+                    const Rect& region) const;
+
+    /**
+     * \brief Appends the image indices and depths of all finite pixels of the
+     *        buffer covering \a rect
+     */
+    static void collect(const Rect& rect,
+                        int n_cols,
+                        const float* buffer,
+                        std::vector<int>& intersect_indices,
+                        std::vector<float>& depth);
+
+    /**
+     * \brief Column scan rasterization of a single triangle given in image
+     *        coordinates. The depth is recovered by intersecting the pixel
+     *        ray with the plane normal.dot(x) = offset. The rays are taken
+     *        from \a rays if given and computed from \a inv_camera_matrix
+     *        otherwise.
+     */
+    void render_triangle(const Eigen::Vector2d* vertices,
+                         const Vector& normal,
+                         float offset,
+                         const Matrix& inv_camera_matrix,
+                         const RayTable* rays,
+                         const Rect& viewport,
+                         float* buffer) const;
+
     // protected:
 public:
     Matrix camera_matrix_;
     int n_rows_;
     int n_cols_;
 
-    // triangles
+    // pixel rays of camera_matrix_, updated by parameters()
+    RayTable rays_;
+
+    // triangles of all meshes. The first part_count_ meshes are the parts,
+    // followed by the coarser levels of detail.
     std::vector<std::vector<Vector>> vertices_;
     std::vector<std::vector<Vector>> normals_;
     std::vector<std::vector<std::vector<int>>> indices_;
 
+    // meshes of each part ordered from fine to coarse
+    size_t part_count_;
+    std::vector<std::vector<size_t>> levels_;
+    double lod_pixels_per_triangle_;
+
+    // per mesh bounding spheres and the sign of the enclosed volume which is
+    // negative for inward facing normals. The spheres of the parts contain
+    // all of their levels.
+    std::vector<Vector> centers_;
+    std::vector<double> radii_;
+    std::vector<double> orientations_;
+
+    // per mesh float copies of the vertices stored as x, y and z arrays and
+    // of the normals stored as x, y, z and offset arrays, where the offset
+    // is normal.dot(vertex) of the first triangle vertex
+    std::vector<std::vector<float>> packed_vertices_;
+    std::vector<std::vector<float>> packed_normals_;
+
     // state
     std::vector<Matrix> R_;
     std::vector<Vector> t_;
@@ -150,5 +505,12 @@ public:
     // cached center of mass
     std::vector<Vector> coms_;
     std::vector<float> com_weights_;
+
+    Rasterizer rasterizer_;
+    Precision precision_;
+    bool back_face_culling_;
+    bool frustum_culling_;
+    std::shared_ptr<Executor> executor_;
+    size_t revision_;
 };
 }
@@ -0,0 +1,565 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file rigid_body_renderer_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <thread>
+
+#include <dbot/rigid_body_renderer.h>
+#include <dbot/thread_pool.h>
+
+namespace
+{
+bool count_allocations = false;
+int allocation_count = 0;
+}
+
+/**
+ * Counts the heap allocations of this test executable while
+ * count_allocations is set. The functions are kept out of line, otherwise
+ * GCC sees the std::free of the inlined delete applied to pointers returned
+ * by new and warns about mismatched allocation functions. The sized delete
+ * is replaced along with the unsized one such that both release through
+ * std::free.
+ */
+__attribute__((noinline)) void* operator new(std::size_t size)
+{
+    if (count_allocations) allocation_count++;
+
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+typedef dbot::RigidBodyRenderer Renderer;
+
+/**
+ * Axis aligned box centered at the origin made of 12 triangles
+ */
+void box(double sx,
+         double sy,
+         double sz,
+         std::vector<Eigen::Vector3d>& vertices,
+         std::vector<std::vector<int>>& indices)
+{
+    vertices.clear();
+    for (int i = 0; i < 8; ++i)
+    {
+        vertices.push_back(Eigen::Vector3d((i & 1 ? 0.5 : -0.5) * sx,
+                                           (i & 2 ? 0.5 : -0.5) * sy,
+                                           (i & 4 ? 0.5 : -0.5) * sz));
+    }
+
+    indices = {{0, 2, 1}, {1, 2, 3}, {4, 5, 6}, {5, 7, 6}, {0, 1, 4}, {1, 5, 4},
+               {2, 6, 3}, {3, 6, 7}, {0, 4, 2}, {2, 4, 6}, {1, 3, 5}, {3, 7, 5}};
+}
+
+Eigen::Matrix3d camera_matrix()
+{
+    Eigen::Matrix3d camera_matrix;
+    camera_matrix << 525., 0., 319.5, 0., 525., 239.5, 0., 0., 1.;
+    return camera_matrix;
+}
+
+Renderer::Affine pose(double x, double y, double z, double angle)
+{
+    Renderer::Affine pose;
+    pose.setIdentity();
+    pose.translate(Eigen::Vector3d(x, y, z));
+    pose.rotate(
+        Eigen::AngleAxisd(angle, Eigen::Vector3d(1, 2, 3).normalized()));
+    return pose;
+}
+
+/**
+ * Compares two depth images. Coverage may only differ at triangle edges due to
+ * the sub-pixel snapping. At such pixels either the background or a
+ * neighbouring triangle is visible in one of the renderings, so these are
+ * counted instead of compared.
+ */
+void expect_equal_images(const std::vector<float>& reference,
+                         const std::vector<float>& tiled)
+{
+    ASSERT_EQ(reference.size(), tiled.size());
+
+    int covered = 0;
+    int edge_mismatch = 0;
+    double max_error = 0;
+    for (size_t i = 0; i < reference.size(); ++i)
+    {
+        bool in_reference = std::isfinite(reference[i]);
+        bool in_tiled = std::isfinite(tiled[i]);
+
+        if (in_reference) covered++;
+        if (!in_reference && !in_tiled) continue;
+
+        double error = std::fabs(reference[i] - tiled[i]) / reference[i];
+        if (in_reference != in_tiled || error > 1e-5)
+        {
+            edge_mismatch++;
+            continue;
+        }
+        max_error = std::max(max_error, error);
+    }
+
+    EXPECT_GT(covered, 0);
+    EXPECT_LE(edge_mismatch, covered / 100 + 2);
+    EXPECT_LT(max_error, 1e-5);
+}
+
+/**
+ * Renders the scene with both rasterizers and compares the depth images
+ */
+void expect_equal_renderings(Renderer& renderer, int n_rows, int n_cols)
+{
+    std::vector<float> reference, tiled;
+    renderer.rasterizer(Renderer::Rasterizer::Reference);
+    renderer.Render(camera_matrix(), n_rows, n_cols, reference);
+    renderer.rasterizer(Renderer::Rasterizer::Tiled);
+    renderer.Render(camera_matrix(), n_rows, n_cols, tiled);
+
+    expect_equal_images(reference, tiled);
+}
+}
+
+TEST(RigidBodyRendererTests, tiled_matches_reference_single_part)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices(1);
+    std::vector<std::vector<std::vector<int>>> indices(1);
+    box(0.1, 0.2, 0.15, vertices[0], indices[0]);
+
+    Renderer renderer(vertices, indices);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        renderer.set_poses({pose(0.01 * i - 0.1, 0.005 * i, 0.5 + 0.05 * i, i)});
+        expect_equal_renderings(renderer, 480, 640);
+    }
+}
+
+TEST(RigidBodyRendererTests, tiled_matches_reference_multiple_parts)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices(3);
+    std::vector<std::vector<std::vector<int>>> indices(3);
+    box(0.1, 0.1, 0.1, vertices[0], indices[0]);
+    box(0.3, 0.05, 0.05, vertices[1], indices[1]);
+    box(0.02, 0.2, 0.02, vertices[2], indices[2]);
+
+    Renderer renderer(vertices, indices);
+    renderer.set_poses({pose(0.0, 0.0, 0.8, 0.3),
+                        pose(0.05, 0.02, 0.75, 1.2),
+                        pose(-0.1, 0.0, 0.7, 2.0)});
+
+    expect_equal_renderings(renderer, 480, 640);
+}
+
+TEST(RigidBodyRendererTests, tiled_handles_image_border)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices(1);
+    std::vector<std::vector<std::vector<int>>> indices(1);
+    box(0.2, 0.2, 0.2, vertices[0], indices[0]);
+
+    Renderer renderer(vertices, indices);
+
+    // partially outside of the image and very close to the camera such that
+    // some triangles exceed the maximum tile rasterizer extent
+    renderer.set_poses({pose(0.3, 0.2, 0.8, 0.4)});
+    expect_equal_renderings(renderer, 480, 640);
+
+    renderer.set_poses({pose(0.0, 0.0, 0.15, 0.1)});
+    expect_equal_renderings(renderer, 480, 640);
+
+    // odd image size which is not a multiple of the tile size
+    renderer.set_poses({pose(-0.27, -0.2, 0.5, 0.7)});
+    expect_equal_renderings(renderer, 61, 83);
+}
+
+TEST(RigidBodyRendererTests, ray_table_matches_direct_rays)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices(2);
+    std::vector<std::vector<std::vector<int>>> indices(2);
+    box(0.1, 0.2, 0.15, vertices[0], indices[0]);
+    box(0.3, 0.05, 0.05, vertices[1], indices[1]);
+
+    // the rays of the first renderer are tabulated for its parameters, the
+    // second one has none and computes them per pixel
+    Renderer tabulated(vertices, indices, camera_matrix(), 480, 640);
+    Renderer direct(vertices, indices);
+    tabulated.rasterizer(Renderer::Rasterizer::Reference);
+    direct.rasterizer(Renderer::Rasterizer::Reference);
+
+    Eigen::Matrix3d scaled_camera_matrix = camera_matrix();
+    scaled_camera_matrix.topRows(2) *= 0.5;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        std::vector<Renderer::Affine> poses = {
+            pose(0.02 * i - 0.1, 0.01 * i, 0.4 + 0.05 * i, i),
+            pose(0.0, 0.01 * i, 0.3 + 0.1 * i, 0.3 * i)};
+        tabulated.set_poses(poses);
+        direct.set_poses(poses);
+
+        std::vector<float> tabulated_image, direct_image;
+        tabulated.Render(camera_matrix(), 480, 640, tabulated_image);
+        direct.Render(camera_matrix(), 480, 640, direct_image);
+        expect_equal_images(direct_image, tabulated_image);
+
+        // the table follows parameters()
+        tabulated.parameters(scaled_camera_matrix, 240, 320);
+        tabulated.Render(scaled_camera_matrix, 240, 320, tabulated_image);
+        direct.Render(scaled_camera_matrix, 240, 320, direct_image);
+        expect_equal_images(direct_image, tabulated_image);
+        tabulated.parameters(camera_matrix(), 480, 640);
+    }
+}
+
+TEST(RigidBodyRendererTests, single_precision_matches_double)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices(2);
+    std::vector<std::vector<std::vector<int>>> indices(2);
+    box(0.1, 0.2, 0.15, vertices[0], indices[0]);
+    box(0.3, 0.05, 0.05, vertices[1], indices[1]);
+
+    Renderer renderer(vertices, indices);
+    renderer.rasterizer(Renderer::Rasterizer::Tiled);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        renderer.set_poses({pose(0.01 * i - 0.1, 0.005 * i, 0.4 + 0.05 * i, i),
+                            pose(0.0, 0.01 * i, 0.15 + 0.1 * i, 0.3 * i)});
+
+        std::vector<float> double_image, single_image;
+        renderer.precision(Renderer::Precision::Double);
+        renderer.Render(camera_matrix(), 480, 640, double_image);
+        renderer.precision(Renderer::Precision::Single);
+        renderer.Render(camera_matrix(), 480, 640, single_image);
+
+        expect_equal_images(double_image, single_image);
+    }
+}
+
+TEST(RigidBodyRendererTests, batch_matches_single_renderings)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices(2);
+    std::vector<std::vector<std::vector<int>>> indices(2);
+    box(0.1, 0.1, 0.1, vertices[0], indices[0]);
+    box(0.3, 0.05, 0.05, vertices[1], indices[1]);
+
+    Renderer renderer(vertices, indices);
+    renderer.executor(std::make_shared<dbot::ThreadPool>(3));
+
+    std::vector<std::vector<Renderer::Affine>> poses;
+    for (int i = 0; i < 10; ++i)
+    {
+        poses.push_back({pose(0.01 * i, 0.0, 0.8, 0.1 * i),
+                         pose(0.0, 0.01 * i, 0.7, 0.2 * i)});
+    }
+
+    std::vector<float> atlas;
+    renderer.RenderBatch(poses, camera_matrix(), 120, 160, atlas);
+    ASSERT_EQ(atlas.size(), poses.size() * 120 * 160);
+
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+        std::vector<float> depth_image;
+        renderer.set_poses(poses[i]);
+        renderer.Render(camera_matrix(), 120, 160, depth_image);
+
+        EXPECT_TRUE(std::equal(depth_image.begin(),
+                               depth_image.end(),
+                               atlas.begin() + i * depth_image.size()));
+    }
+}
+
+TEST(RigidBodyRendererTests, concurrent_batches_match)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices(2);
+    std::vector<std::vector<std::vector<int>>> indices(2);
+    box(0.1, 0.1, 0.1, vertices[0], indices[0]);
+    box(0.3, 0.05, 0.05, vertices[1], indices[1]);
+
+    Renderer renderer(vertices, indices);
+    renderer.executor(std::make_shared<dbot::SerialExecutor>(3));
+
+    std::vector<std::vector<Renderer::Affine>> poses;
+    for (int i = 0; i < 10; ++i)
+    {
+        poses.push_back({pose(0.01 * i, 0.0, 0.8, 0.1 * i),
+                         pose(0.0, 0.01 * i, 0.7, 0.2 * i)});
+    }
+
+    std::vector<float> expected;
+    renderer.RenderBatch(poses, camera_matrix(), 120, 160, expected);
+
+    // each caller renders with its own batch context
+    std::vector<float> atlases[4];
+    std::vector<std::thread> threads;
+    for (auto& atlas : atlases)
+    {
+        threads.emplace_back([&]()
+                             {
+                                 Renderer::BatchContext context;
+                                 for (int k = 0; k < 5; ++k)
+                                 {
+                                     renderer.RenderBatch(poses,
+                                                          camera_matrix(),
+                                                          120,
+                                                          160,
+                                                          context,
+                                                          atlas);
+                                 }
+                             });
+    }
+    for (auto& thread : threads) thread.join();
+
+    for (auto& atlas : atlases) EXPECT_EQ(atlas, expected);
+}
+
+TEST(RigidBodyRendererTests, sparse_matches_dense_rendering)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices(2);
+    std::vector<std::vector<std::vector<int>>> indices(2);
+    box(0.1, 0.1, 0.1, vertices[0], indices[0]);
+    box(0.3, 0.05, 0.05, vertices[1], indices[1]);
+
+    Renderer renderer(vertices, indices);
+
+    for (auto rasterizer :
+         {Renderer::Rasterizer::Reference, Renderer::Rasterizer::Tiled})
+    {
+        renderer.rasterizer(rasterizer);
+
+        for (int i = 0; i < 10; ++i)
+        {
+            // the last poses move the object across the image border
+            renderer.set_poses({pose(0.04 * i, 0.0, 0.6, 0.3 * i),
+                                pose(0.0, 0.03 * i, 0.7, 0.2 * i)});
+
+            std::vector<float> depth_image;
+            renderer.Render(camera_matrix(), 480, 640, depth_image);
+
+            std::vector<int> intersect_indices;
+            std::vector<float> depth;
+            renderer.Render(
+                camera_matrix(), 480, 640, intersect_indices, depth);
+
+            std::vector<float> scattered(
+                depth_image.size(), std::numeric_limits<float>::infinity());
+            for (size_t j = 0; j < intersect_indices.size(); ++j)
+            {
+                scattered[intersect_indices[j]] = depth[j];
+            }
+
+            EXPECT_TRUE(std::is_sorted(intersect_indices.begin(),
+                                       intersect_indices.end()));
+            EXPECT_GT(intersect_indices.size(), 0);
+            EXPECT_EQ(depth_image, scattered);
+        }
+    }
+}
+
+TEST(RigidBodyRendererTests, render_context_avoids_allocations)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices(2);
+    std::vector<std::vector<std::vector<int>>> indices(2);
+    box(0.1, 0.1, 0.1, vertices[0], indices[0]);
+    box(0.3, 0.05, 0.05, vertices[1], indices[1]);
+
+    Renderer renderer(vertices, indices);
+    renderer.executor(std::make_shared<dbot::SerialExecutor>(3));
+
+    std::vector<std::vector<Renderer::Affine>> poses;
+    for (int i = 0; i < 10; ++i)
+    {
+        poses.push_back({pose(0.02 * i, 0.0, 0.9 - 0.04 * i, 0.3 * i),
+                         pose(0.0, 0.01 * i, 0.7, 0.2 * i)});
+    }
+
+    Renderer::RenderContext context;
+    Renderer::BatchContext batch_context;
+    std::vector<int> intersect_indices;
+    std::vector<float> depth;
+    std::vector<float> atlas;
+    const Eigen::Matrix3d camera = camera_matrix();
+
+    for (auto rasterizer :
+         {Renderer::Rasterizer::Reference, Renderer::Rasterizer::Tiled})
+    {
+        renderer.rasterizer(rasterizer);
+
+        // the first pass grows the buffers, the second one has to reuse them
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            allocation_count = 0;
+            count_allocations = pass == 1;
+
+            for (size_t i = 0; i < poses.size(); ++i)
+            {
+                renderer.set_poses(poses[i]);
+                renderer.Render(
+                    camera, 480, 640, context, intersect_indices, depth);
+
+                for (size_t k = 0; k < poses[i].size(); ++k)
+                {
+                    renderer.RenderPart(k,
+                                        poses[i][k],
+                                        camera,
+                                        480,
+                                        640,
+                                        context,
+                                        intersect_indices,
+                                        depth);
+                }
+            }
+
+            // the batch reuses the work buffers of the executor chunks
+            renderer.RenderBatch(
+                poses, camera, 480, 640, batch_context, atlas);
+
+            count_allocations = false;
+        }
+
+        EXPECT_EQ(allocation_count, 0);
+        EXPECT_GT(intersect_indices.size(), 0);
+    }
+}
+
+TEST(RigidBodyRendererTests, culling_preserves_rendering)
+{
+    std::vector<std::vector<Eigen::Vector3d>> vertices(3);
+    std::vector<std::vector<std::vector<int>>> indices(3);
+    box(0.1, 0.1, 0.1, vertices[0], indices[0]);
+    box(0.3, 0.05, 0.05, vertices[1], indices[1]);
+    box(0.05, 0.05, 0.2, vertices[2], indices[2]);
+
+    // inward facing normals have to be detected
+    for (auto& triangle : indices[2]) std::swap(triangle[1], triangle[2]);
+
+    Renderer renderer(vertices, indices);
+
+    for (auto rasterizer :
+         {Renderer::Rasterizer::Reference, Renderer::Rasterizer::Tiled})
+    {
+        renderer.rasterizer(rasterizer);
+
+        for (int i = 0; i < 10; ++i)
+        {
+            // part 2 leaves the image and ends up behind the camera
+            renderer.set_poses({pose(0.01 * i, 0.0, 0.6, 0.3 * i),
+                                pose(0.0, 0.02 * i, 0.7, 0.2 * i),
+                                pose(0.1 * i, 0.0, 0.5 - 0.1 * i, 0.5 * i)});
+
+            std::vector<float> expected;
+            renderer.back_face_culling(false);
+            renderer.frustum_culling(false);
+            renderer.Render(camera_matrix(), 480, 640, expected);
+
+            std::vector<float> culled;
+            renderer.back_face_culling(true);
+            renderer.frustum_culling(true);
+            renderer.Render(camera_matrix(), 480, 640, culled);
+
+            // the coverage is the same, but at silhouette edges the culled
+            // back face may have won against the snapped front face
+            ASSERT_EQ(expected.size(), culled.size());
+            int covered = 0;
+            int edge_mismatch = 0;
+            for (size_t j = 0; j < expected.size(); ++j)
+            {
+                ASSERT_EQ(std::isfinite(expected[j]), std::isfinite(culled[j]));
+                if (!std::isfinite(expected[j])) continue;
+
+                covered++;
+                if (expected[j] != culled[j]) edge_mismatch++;
+                EXPECT_NEAR(expected[j], culled[j], 1e-3 * expected[j]);
+            }
+            EXPECT_LE(edge_mismatch, covered / 100 + 2);
+        }
+    }
+}
+
+TEST(RigidBodyRendererTests, level_of_detail_depends_on_projected_size)
+{
+    // the fine level consists of two boxes, the coarse one of a single box
+    std::vector<Eigen::Vector3d> box_vertices, offset_vertices;
+    std::vector<std::vector<int>> box_indices, offset_indices;
+    box(0.1, 0.1, 0.1, box_vertices, box_indices);
+    box(0.05, 0.2, 0.05, offset_vertices, offset_indices);
+
+    std::vector<std::vector<Eigen::Vector3d>> fine_vertices = {box_vertices};
+    std::vector<std::vector<std::vector<int>>> fine_indices = {box_indices};
+    for (size_t i = 0; i < offset_vertices.size(); ++i)
+    {
+        fine_vertices[0].push_back(offset_vertices[i] +
+                                   Eigen::Vector3d(0.1, 0, 0));
+    }
+    for (auto triangle : offset_indices)
+    {
+        for (int& index : triangle) index += box_vertices.size();
+        fine_indices[0].push_back(triangle);
+    }
+
+    std::vector<std::vector<Eigen::Vector3d>> coarse_vertices = {box_vertices};
+    std::vector<std::vector<std::vector<int>>> coarse_indices = {box_indices};
+
+    Renderer renderer(fine_vertices, fine_indices);
+    renderer.add_level_of_detail(coarse_vertices, coarse_indices);
+    renderer.lod_pixels_per_triangle(1000);
+
+    Renderer fine(fine_vertices, fine_indices);
+    Renderer coarse(coarse_vertices, coarse_indices);
+
+    for (double z : {0.5, 3.0})
+    {
+        std::vector<Renderer::Affine> poses = {pose(0.0, 0.0, z, 0.4)};
+        renderer.set_poses(poses);
+        fine.set_poses(poses);
+        coarse.set_poses(poses);
+
+        std::vector<float> image, expected;
+        renderer.Render(camera_matrix(), 480, 640, image);
+        (z < 1. ? fine : coarse).Render(camera_matrix(), 480, 640, expected);
+        EXPECT_EQ(image, expected);
+
+        std::vector<int> intersect_indices, expected_indices;
+        std::vector<float> depth, expected_depth;
+        renderer.Render(camera_matrix(), 480, 640, intersect_indices, depth);
+        (z < 1. ? fine : coarse)
+            .Render(
+                camera_matrix(), 480, 640, expected_indices, expected_depth);
+        EXPECT_EQ(intersect_indices, expected_indices);
+        EXPECT_EQ(depth, expected_depth);
+    }
+}
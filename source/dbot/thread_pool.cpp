@@ -0,0 +1,113 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file thread_pool.cpp
+ * \date October 2016
+ */
+
+#include <algorithm>
+#include <dbot/thread_pool.h>
+
+namespace dbot
+{
+struct ThreadPool::Job
+{
+    const Task* task;
+    size_t count;
+    int pending;
+};
+
+ThreadPool::ThreadPool(int thread_count) : stop_(false)
+{
+    if (thread_count <= 0)
+    {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    thread_count_ = thread_count;
+
+    for (int i = 1; i < thread_count_; ++i)
+    {
+        workers_.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    changed_.notify_all();
+
+    for (auto& worker : workers_) worker.join();
+}
+
+int ThreadPool::thread_count() const
+{
+    return thread_count_;
+}
+
+void ThreadPool::parallel_for(size_t count, const Task& task)
+{
+    if (count == 0) return;
+
+    Job job;
+    job.task = &task;
+    job.count = count;
+    job.pending = thread_count_;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (int chunk = 0; chunk < thread_count_; ++chunk)
+    {
+        queue_.emplace_back(&job, chunk);
+    }
+    changed_.notify_all();
+
+    // help out until all chunks of this job are done
+    while (job.pending > 0)
+    {
+        if (!run_next(lock)) changed_.wait(lock);
+    }
+}
+
+bool ThreadPool::run_next(std::unique_lock<std::mutex>& lock)
+{
+    if (queue_.empty()) return false;
+
+    Job* job = queue_.front().first;
+    int chunk = queue_.front().second;
+    queue_.pop_front();
+
+    lock.unlock();
+    size_t begin, end;
+    chunk_range(job->count, thread_count_, chunk, begin, end);
+    if (begin < end) (*job->task)(chunk, begin, end);
+    lock.lock();
+
+    if (--job->pending == 0) changed_.notify_all();
+
+    return true;
+}
+
+void ThreadPool::work()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        if (run_next(lock)) continue;
+        if (stop_) return;
+        changed_.wait(lock);
+    }
+}
+}
@@ -0,0 +1,67 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file thread_pool.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <dbot/executor.h>
+
+namespace dbot
+{
+/**
+ * \brief Executor running the chunks on a fixed set of worker threads
+ *
+ * The calling thread takes part in the execution. Threads waiting for their
+ * chunks to complete keep executing queued chunks, hence parallel_for may be
+ * called from within a running task.
+ */
+class ThreadPool : public Executor
+{
+public:
+    /**
+     * \brief Creates a pool of thread_count - 1 workers. A thread count of zero
+     *        selects the number of hardware threads.
+     */
+    explicit ThreadPool(int thread_count = 0);
+
+    virtual ~ThreadPool();
+
+    void parallel_for(size_t count, const Task& task);
+
+    int thread_count() const;
+
+private:
+    struct Job;
+
+    void work();
+    bool run_next(std::unique_lock<std::mutex>& lock);
+
+private:
+    int thread_count_;
+    bool stop_;
+    std::vector<std::thread> workers_;
+    std::deque<std::pair<Job*, int>> queue_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+};
+}
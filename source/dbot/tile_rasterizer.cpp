@@ -0,0 +1,346 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tile_rasterizer.cpp
+ * \date October 2016
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <dbot/tile_rasterizer.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace dbot
+{
+namespace
+{
+/**
+ * \internal
+ * Edge functions and inverse depth of a triangle. All values refer to the
+ * pixel at the current position, the steps to a move by one pixel.
+ */
+struct TriangleSetup
+{
+    int e[3];
+    int step_col[3];
+    int step_row[3];
+    double inv_depth;
+    double inv_depth_step_col;
+    double inv_depth_step_row;
+};
+
+/**
+ * \internal
+ * Scalar version of the row kernel. Fills \a count <= TILE_SIZE pixels.
+ */
+inline void fill_row_scalar(const int* e,
+                            const int* step,
+                            float inv_depth,
+                            float inv_depth_step,
+                            int count,
+                            float* depth)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        int e0 = e[0] + i * step[0];
+        int e1 = e[1] + i * step[1];
+        int e2 = e[2] + i * step[2];
+
+        if ((e0 | e1 | e2) >= 0)
+        {
+            float d = std::fabs(1.f / (inv_depth + float(i) * inv_depth_step));
+            if (d < depth[i]) depth[i] = d;
+        }
+    }
+}
+
+#if defined(__AVX2__)
+/**
+ * \internal
+ * AVX2 row kernel testing and writing all TILE_SIZE pixels at once
+ */
+class RowKernel
+{
+public:
+    explicit RowKernel(const TriangleSetup& t, float inv_depth_step)
+    {
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        for (int k = 0; k < 3; ++k)
+        {
+            offsets_[k] =
+                _mm256_mullo_epi32(lanes, _mm256_set1_epi32(t.step_col[k]));
+        }
+        depth_offsets_ = _mm256_mul_ps(
+            _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f),
+            _mm256_set1_ps(inv_depth_step));
+    }
+
+    void operator()(const int* e, float inv_depth, float* depth) const
+    {
+        __m256i e0 = _mm256_add_epi32(_mm256_set1_epi32(e[0]), offsets_[0]);
+        __m256i e1 = _mm256_add_epi32(_mm256_set1_epi32(e[1]), offsets_[1]);
+        __m256i e2 = _mm256_add_epi32(_mm256_set1_epi32(e[2]), offsets_[2]);
+
+        // a pixel is inside if none of the edge functions is negative
+        __m256 outside = _mm256_castsi256_ps(
+            _mm256_or_si256(_mm256_or_si256(e0, e1), e2));
+        if (_mm256_movemask_ps(outside) == 0xFF) return;
+
+        __m256 inv = _mm256_add_ps(_mm256_set1_ps(inv_depth), depth_offsets_);
+        __m256 d = _mm256_andnot_ps(_mm256_set1_ps(-0.f),
+                                    _mm256_div_ps(_mm256_set1_ps(1.f), inv));
+        __m256 current = _mm256_loadu_ps(depth);
+        __m256 result =
+            _mm256_blendv_ps(_mm256_min_ps(d, current), current, outside);
+        _mm256_storeu_ps(depth, result);
+    }
+
+private:
+    __m256i offsets_[3];
+    __m256 depth_offsets_;
+};
+
+const char* const kernel = "avx2";
+
+#elif defined(__SSE2__)
+/**
+ * \internal
+ * SSE2 row kernel testing and writing all TILE_SIZE pixels in two halves
+ */
+class RowKernel
+{
+public:
+    explicit RowKernel(const TriangleSetup& t, float inv_depth_step)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            offsets_[k][0] = _mm_setr_epi32(0,
+                                            t.step_col[k],
+                                            2 * t.step_col[k],
+                                            3 * t.step_col[k]);
+            offsets_[k][1] =
+                _mm_add_epi32(offsets_[k][0], _mm_set1_epi32(4 * t.step_col[k]));
+        }
+        depth_offsets_[0] = _mm_mul_ps(_mm_setr_ps(0.f, 1.f, 2.f, 3.f),
+                                       _mm_set1_ps(inv_depth_step));
+        depth_offsets_[1] = _mm_mul_ps(_mm_setr_ps(4.f, 5.f, 6.f, 7.f),
+                                       _mm_set1_ps(inv_depth_step));
+    }
+
+    void operator()(const int* e, float inv_depth, float* depth) const
+    {
+        for (int h = 0; h < 2; ++h)
+        {
+            __m128i e0 = _mm_add_epi32(_mm_set1_epi32(e[0]), offsets_[0][h]);
+            __m128i e1 = _mm_add_epi32(_mm_set1_epi32(e[1]), offsets_[1][h]);
+            __m128i e2 = _mm_add_epi32(_mm_set1_epi32(e[2]), offsets_[2][h]);
+
+            // a pixel is inside if none of the edge functions is negative
+            __m128i outside = _mm_srai_epi32(
+                _mm_or_si128(_mm_or_si128(e0, e1), e2), 31);
+            __m128 outside_mask = _mm_castsi128_ps(outside);
+            if (_mm_movemask_ps(outside_mask) == 0xF) continue;
+
+            float* dst = depth + 4 * h;
+            __m128 inv =
+                _mm_add_ps(_mm_set1_ps(inv_depth), depth_offsets_[h]);
+            __m128 d = _mm_andnot_ps(_mm_set1_ps(-0.f),
+                                     _mm_div_ps(_mm_set1_ps(1.f), inv));
+            __m128 current = _mm_loadu_ps(dst);
+            __m128 result =
+                _mm_or_ps(_mm_and_ps(outside_mask, current),
+                          _mm_andnot_ps(outside_mask, _mm_min_ps(d, current)));
+            _mm_storeu_ps(dst, result);
+        }
+    }
+
+private:
+    __m128i offsets_[3][2];
+    __m128 depth_offsets_[2];
+};
+
+const char* const kernel = "sse2";
+
+#else
+/**
+ * \internal
+ * Portable row kernel used if no SIMD instruction set is available
+ */
+class RowKernel
+{
+public:
+    RowKernel(const TriangleSetup& t, float inv_depth_step)
+        : inv_depth_step_(inv_depth_step)
+    {
+        std::copy(t.step_col, t.step_col + 3, step_);
+    }
+
+    void operator()(const int* e, float inv_depth, float* depth) const
+    {
+        fill_row_scalar(e,
+                        step_,
+                        inv_depth,
+                        inv_depth_step_,
+                        TileRasterizer::TILE_SIZE,
+                        depth);
+    }
+
+private:
+    int step_[3];
+    float inv_depth_step_;
+};
+
+const char* const kernel = "scalar";
+#endif
+}
+
+TileRasterizer::TileRasterizer(int n_rows,
+                               int n_cols,
+                               float* depth,
+                               int row_offset,
+                               int col_offset)
+    : n_rows_(n_rows),
+      n_cols_(n_cols),
+      depth_(depth),
+      row_offset_(row_offset),
+      col_offset_(col_offset)
+{
+}
+
+const char* TileRasterizer::kernel_name()
+{
+    return kernel;
+}
+
+bool TileRasterizer::draw(const double* vertices, const double* inv_depth_plane)
+{
+    const int T = TILE_SIZE;
+    const int one = 1 << SUBPIXEL_BITS;
+
+    // bounding box of the triangle within the buffer ------------------------
+    double min_x = std::min({vertices[0], vertices[2], vertices[4]});
+    double max_x = std::max({vertices[0], vertices[2], vertices[4]});
+    double min_y = std::min({vertices[1], vertices[3], vertices[5]});
+    double max_y = std::max({vertices[1], vertices[3], vertices[5]});
+
+    if (!(max_x - min_x <= MAX_EXTENT && max_y - min_y <= MAX_EXTENT))
+    {
+        // too large for 32 bit edge functions (or not finite at all)
+        return false;
+    }
+
+    int min_col = std::max(col_offset_, int(std::ceil(min_x)));
+    int max_col = std::min(col_offset_ + n_cols_ - 1, int(std::floor(max_x)));
+    int min_row = std::max(row_offset_, int(std::ceil(min_y)));
+    int max_row = std::min(row_offset_ + n_rows_ - 1, int(std::floor(max_y)));
+
+    if (max_col < min_col || max_row < min_row) return true;
+
+    // snap vertices to the fixed point grid relative to the bounding box ----
+    int64_t x[3], y[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        x[i] = std::llround((vertices[2 * i] - min_col) * one);
+        y[i] = std::llround((vertices[2 * i + 1] - min_row) * one);
+    }
+
+    int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    if (area == 0) return true;  // degenerate triangle
+    int64_t orientation = area > 0 ? 1 : -1;
+
+    // edge functions at the bounding box origin -----------------------------
+    TriangleSetup t;
+    for (int i = 0; i < 3; ++i)
+    {
+        int j = (i + 1) % 3;
+        int64_t dx = (x[j] - x[i]) * orientation;
+        int64_t dy = (y[j] - y[i]) * orientation;
+
+        t.e[i] = int(dx * (0 - y[i]) - dy * (0 - x[i]));
+        t.step_col[i] = int(-dy * one);
+        t.step_row[i] = int(dx * one);
+    }
+
+    t.inv_depth_step_col = inv_depth_plane[0];
+    t.inv_depth_step_row = inv_depth_plane[1];
+    t.inv_depth = inv_depth_plane[0] * min_col + inv_depth_plane[1] * min_row +
+                  inv_depth_plane[2];
+
+    const RowKernel row_kernel(t, float(t.inv_depth_step_col));
+
+    // walk over the tiles ---------------------------------------------------
+    for (int tile_row = min_row; tile_row <= max_row; tile_row += T)
+    {
+        const int rows = std::min(T, max_row - tile_row + 1);
+
+        for (int tile_col = min_col; tile_col <= max_col; tile_col += T)
+        {
+            const int cols = std::min(T, max_col - tile_col + 1);
+            const int d_row = tile_row - min_row;
+            const int d_col = tile_col - min_col;
+
+            // edge functions at the tile origin and tile rejection
+            int e[3];
+            bool outside = false;
+            for (int k = 0; k < 3; ++k)
+            {
+                e[k] = t.e[k] + d_row * t.step_row[k] + d_col * t.step_col[k];
+
+                int max_e = e[k] + std::max(0, (cols - 1) * t.step_col[k]) +
+                            std::max(0, (rows - 1) * t.step_row[k]);
+                if (max_e < 0)
+                {
+                    outside = true;
+                    break;
+                }
+            }
+            if (outside) continue;
+
+            double inv_depth = t.inv_depth + d_row * t.inv_depth_step_row +
+                               d_col * t.inv_depth_step_col;
+
+            for (int r = 0; r < rows; ++r)
+            {
+                float* depth = depth_ + (tile_row + r - row_offset_) * n_cols_ +
+                               (tile_col - col_offset_);
+
+                if (cols == T)
+                {
+                    row_kernel(e, float(inv_depth), depth);
+                }
+                else
+                {
+                    fill_row_scalar(e,
+                                    t.step_col,
+                                    float(inv_depth),
+                                    float(t.inv_depth_step_col),
+                                    cols,
+                                    depth);
+                }
+
+                for (int k = 0; k < 3; ++k) e[k] += t.step_row[k];
+                inv_depth += t.inv_depth_step_row;
+            }
+        }
+    }
+
+    return true;
+}
+}
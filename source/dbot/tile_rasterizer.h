@@ -0,0 +1,92 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tile_rasterizer.h
+ * \date October 2016
+ */
+
+#pragma once
+
+namespace dbot
+{
+/**
+ * \brief Edge function triangle rasterizer writing into a depth buffer.
+ *
+ * Triangles are given in image coordinates where pixel (col, row) has its
+ * center at (col, row), i.e. the same convention as the column scan
+ * implementation in RigidBodyRenderer. Vertices are snapped to a fixed point
+ * grid with SUBPIXEL_BITS fractional bits and the three integer edge functions
+ * are evaluated over TILE_SIZE x TILE_SIZE pixel tiles. Tiles which lie
+ * completely outside of one edge are skipped, the remaining ones are filled a
+ * row of TILE_SIZE pixels at a time using SSE or AVX2 if available.
+ *
+ * The depth is interpolated with the inverse depth plane of the triangle,
+ * 1/z = a * col + b * row + c, which is set up once per triangle by the
+ * caller.
+ *
+ * The interface takes plain arrays, such that the implementation, which may
+ * be compiled with AVX2, does not instantiate any Eigen code.
+ */
+class TileRasterizer
+{
+public:
+    enum
+    {
+        TILE_SIZE = 8,
+        SUBPIXEL_BITS = 4,
+
+        /**
+         * Maximum extent of a triangle in pixels. Within this bound all edge
+         * function values fit into 32 bit integers. Larger triangles are
+         * rejected by draw() and have to be rendered by other means.
+         */
+        MAX_EXTENT = 1024
+    };
+
+public:
+    /**
+     * \brief Creates a rasterizer writing into the row-major depth buffer
+     *        \a depth of size \a n_rows x \a n_cols. The buffer covers the
+     *        image region starting at pixel (row_offset, col_offset).
+     */
+    TileRasterizer(int n_rows,
+                   int n_cols,
+                   float* depth,
+                   int row_offset = 0,
+                   int col_offset = 0);
+
+    /**
+     * \brief Rasterizes a single triangle keeping the minimum depth per pixel
+     *
+     * \param vertices        Triangle corners in image coordinates, stored as
+     *                        col0, row0, col1, row1, col2, row2
+     * \param inv_depth_plane Coefficients (a, b, c) of the inverse depth plane
+     *
+     * \return false if the triangle exceeds MAX_EXTENT and has not been drawn
+     */
+    bool draw(const double* vertices, const double* inv_depth_plane);
+
+    /**
+     * \brief Name of the kernel compiled in (avx2, sse2 or scalar)
+     */
+    static const char* kernel_name();
+
+private:
+    int n_rows_;
+    int n_cols_;
+    float* depth_;
+    int row_offset_;
+    int col_offset_;
+};
+}
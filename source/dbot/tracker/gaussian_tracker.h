@@ -102,6 +102,9 @@ public:
      */
     State on_track(const Obsrv& image);
 
+    // the deadline overload of the base class tracks without a deadline
+    using Tracker::on_track;
+
     /**
      * \brief Initializes the particle filter with the given initial states and
      *    the number of evaluations
@@ -21,6 +21,10 @@
  *
  */
 
+#include <algorithm>
+#include <chrono>
+
+#include <dbot/filter/kld_sampling.h>
 #include <dbot/tracker/particle_tracker.h>
 
 namespace dbot
@@ -33,7 +37,9 @@ ParticleTracker::ParticleTracker(
     bool center_object_frame)
     : Tracker(object_model, update_rate, center_object_frame),
       filter_(filter),
-      evaluation_count_(evaluation_count)
+      evaluation_count_(evaluation_count),
+      adaptive_(false),
+      seconds_per_particle_(0)
 {
 }
 
@@ -58,7 +64,17 @@ auto ParticleTracker::on_initialize(
 
 auto ParticleTracker::on_track(const Obsrv& image) -> State
 {
-    filter_->filter(image, zero_input());
+    return on_track(image, Deadline::max());
+}
+
+auto ParticleTracker::on_track(const Obsrv& image, const Deadline& deadline)
+    -> State
+{
+    auto begin = std::chrono::steady_clock::now();
+    filter_->filter(image, zero_input(), deadline);
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - begin)
+                         .count();
 
     State delta_mean = filter_->belief().mean();
 
@@ -70,6 +86,129 @@ auto ParticleTracker::on_track(const Obsrv& image) -> State
     auto& integrated_poses = filter_->sensor()->integrated_poses();
     integrated_poses.apply_delta(delta_mean);
 
+    if (partitioner_ &&
+        partitioner_->update(filter_->block_statistics().ess_drops))
+    {
+        filter_->update_sampling_blocks(partitioner_->sampling_blocks());
+    }
+
+    if (adaptive_)
+    {
+        int count = adapted_particle_count(seconds);
+        if (count != particle_count()) filter_->resample(count);
+    }
+
     return integrated_poses;
 }
+
+void ParticleTracker::adaptive_particle_count(
+    const AdaptiveParticleCount& parameters)
+{
+    adaptive_ = true;
+    adaptive_parameters_ = parameters;
+    seconds_per_particle_ = 0;
+}
+
+void ParticleTracker::fixed_particle_count()
+{
+    adaptive_ = false;
+}
+
+int ParticleTracker::particle_count() const
+{
+    return filter_->belief().size();
+}
+
+void ParticleTracker::adaptive_sampling_blocks(
+    const SamplingBlockPartitioner::Parameters& parameters)
+{
+    std::vector<std::vector<int>> atoms;
+    std::vector<std::vector<int>> partition;
+    for (const auto& block : filter_->sampling_blocks())
+    {
+        partition.push_back(std::vector<int>());
+
+        const size_t half = (block.size() + 1) / 2;
+        atoms.emplace_back(block.begin(), block.begin() + half);
+        partition.back().push_back(atoms.size() - 1);
+        if (half == block.size()) continue;
+
+        atoms.emplace_back(block.begin() + half, block.end());
+        partition.back().push_back(atoms.size() - 1);
+    }
+
+    partitioner_ =
+        std::make_shared<SamplingBlockPartitioner>(atoms, partition, parameters);
+}
+
+void ParticleTracker::fixed_sampling_blocks()
+{
+    partitioner_.reset();
+}
+
+void ParticleTracker::save_checkpoint(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    CheckpointWriter checkpoint;
+    filter_->save(checkpoint);
+    checkpoint.add("tracker/moving_average",
+                   moving_average_.data(),
+                   moving_average_.size());
+    checkpoint.write(path);
+}
+
+void ParticleTracker::load_checkpoint(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    CheckpointReader checkpoint(path);
+    std::vector<double> moving_average =
+        checkpoint.vector<double>("tracker/moving_average");
+
+    filter_->load(checkpoint);
+    moving_average_.recount(moving_average.size() / State::BODY_SIZE);
+    for (size_t i = 0; i < moving_average.size(); i++)
+    {
+        moving_average_(i) = moving_average[i];
+    }
+}
+
+int ParticleTracker::adapted_particle_count(double seconds)
+{
+    const AdaptiveParticleCount& p = adaptive_parameters_;
+    const int count = particle_count();
+
+    // moving average of the filter time per particle
+    const double rate = 0.2;
+    double sample = seconds / std::max(count, 1);
+    seconds_per_particle_ =
+        seconds_per_particle_ > 0
+            ? (1 - rate) * seconds_per_particle_ + rate * sample
+            : sample;
+
+    // poses of all parts, the belief is centered at the mean
+    const int part_count = filter_->belief().location(0).count();
+    Eigen::MatrixXd poses(part_count * 6, count);
+    Eigen::VectorXd bin_sizes(part_count * 6);
+    for (int k = 0; k < part_count; k++)
+    {
+        bin_sizes.segment(k * 6, 3).setConstant(p.position_bin_size);
+        bin_sizes.segment(k * 6 + 3, 3).setConstant(p.orientation_bin_size);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        poses.col(i) = filter_->belief().location(i).poses();
+    }
+
+    size_t kld_count = kld_sample_count(
+        occupied_bins(poses, bin_sizes), p.kld_epsilon, p.kld_z);
+    double budget_count = p.time_budget / seconds_per_particle_;
+
+    double adapted = std::min<double>(kld_count, budget_count);
+    adapted = std::max<double>(adapted, p.min_particle_count);
+    adapted = std::min<double>(adapted, p.max_particle_count);
+
+    return int(adapted);
+}
 }
@@ -34,6 +34,7 @@
 
 #include <dbot/tracker/tracker.h>
 #include <dbot/filter/rao_blackwell_coordinate_particle_filter.h>
+#include <dbot/filter/sampling_block_partitioner.h>
 
 namespace dbot
 {
@@ -48,6 +49,30 @@ public:
 
     typedef RaoBlackwellCoordinateParticleFilter<Transition, Sensor> Filter;
 
+    /**
+     * \brief Parameters of the adaptive particle count
+     *
+     * After each frame the particle count of the next frame is chosen by the
+     * KLD-sampling bound on the poses of the belief, limited to the count the
+     * filter can process within the time budget. The time per particle is
+     * measured online.
+     */
+    struct AdaptiveParticleCount
+    {
+        /// bound of the KL divergence of the particle approximation
+        double kld_epsilon;
+        /// upper 1 - delta quantile of the standard normal, e.g. 2.326
+        double kld_z;
+        /// bin sizes of the part positions and orientations
+        double position_bin_size;
+        double orientation_bin_size;
+
+        int min_particle_count;
+        int max_particle_count;
+        /// wall-clock budget of a filter step in seconds
+        double time_budget;
+    };
+
 public:
     /**
      * \brief Creates the tracker
@@ -79,6 +104,18 @@ public:
      */
     State on_track(const Obsrv& image);
 
+    /**
+     * \brief perform a single filter step which skips the remaining sampling
+     *        blocks once the deadline would be exceeded. The skipped blocks
+     *        are reported by the block statistics of the filter.
+     *
+     * \param image
+     *     Current observation image
+     * \param deadline
+     *     Point in time by which the filter step should be done
+     */
+    State on_track(const Obsrv& image, const Deadline& deadline);
+
     /**
      * \brief Initializes the particle filter with the given initial states and
      *    the number of evaluations
@@ -87,8 +124,68 @@ public:
      */
     State on_initialize(const std::vector<State>& initial_states);
 
+    /**
+     * \brief Enables resizing the particle set every frame
+     */
+    void adaptive_particle_count(const AdaptiveParticleCount& parameters);
+
+    /**
+     * \brief Disables the adaptive particle count. The count given by the
+     *        evaluation count is restored on the next initialization.
+     */
+    void fixed_particle_count();
+
+    /**
+     * \return the current number of particles
+     */
+    int particle_count() const;
+
+    /**
+     * \brief Enables adapting the sampling blocks to the drop of the
+     *        effective sample size they cause. Each current block is split
+     *        into at most two halves, i.e. the translation and the rotation
+     *        of a part, which are merged and reordered as needed.
+     */
+    void adaptive_sampling_blocks(
+        const SamplingBlockPartitioner::Parameters& parameters);
+
+    /**
+     * \brief Keeps the current sampling blocks from now on
+     */
+    void fixed_sampling_blocks();
+
+    /**
+     * \brief Writes the state of the filter, the sensor and the moving
+     *        average to the checkpoint file \a path
+     *
+     * \throws CheckpointException if the file cannot be written
+     */
+    void save_checkpoint(const std::string& path);
+
+    /**
+     * \brief Resumes tracking from the checkpoint file \a path instead of
+     *        initializing the tracker
+     *
+     * \throws CheckpointException if the file cannot be read or does not
+     *         match the tracker
+     */
+    void load_checkpoint(const std::string& path);
+
+private:
+    /**
+     * \brief Particle count for the next frame given the duration of the
+     *        last filter step
+     */
+    int adapted_particle_count(double seconds);
+
 private:
     std::shared_ptr<Filter> filter_;
     int evaluation_count_;
+
+    bool adaptive_;
+    AdaptiveParticleCount adaptive_parameters_;
+    double seconds_per_particle_;
+
+    std::shared_ptr<SamplingBlockPartitioner> partitioner_;
 };
 }
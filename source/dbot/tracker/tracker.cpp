@@ -79,6 +79,17 @@ auto Tracker::track(const Obsrv& image) -> State
     return moving_average_;
 }
 
+auto Tracker::track(const Obsrv& image, const Deadline& deadline) -> State
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    move_average(to_model_coordinate_system(on_track(image, deadline)),
+                 moving_average_,
+                 update_rate_);
+
+    return moving_average_;
+}
+
 auto Tracker::to_center_coordinate_system(
     const Tracker::State& state) -> State
 {
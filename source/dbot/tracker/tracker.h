@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <Eigen/Dense>
 #include <dbot/object_model.h>
 #include <dbot/pose/free_floating_rigid_bodies_state.h>
@@ -40,6 +41,7 @@ public:
     typedef Eigen::Matrix<fl::Real, Eigen::Dynamic, 1> Obsrv;
     typedef Eigen::Matrix<fl::Real, Eigen::Dynamic, 1> Noise;
     typedef Eigen::Matrix<fl::Real, Eigen::Dynamic, 1> Input;
+    typedef std::chrono::steady_clock::time_point Deadline;
 
 public:
     /**
@@ -63,6 +65,16 @@ public:
      */
     virtual State on_track(const Obsrv& image) = 0;
 
+    /**
+     * \brief Hook function which is called during tracking with a deadline.
+     *        Trackers which cannot bound their update ignore the deadline.
+     * \return Current belief state
+     */
+    virtual State on_track(const Obsrv& image, const Deadline& deadline)
+    {
+        return on_track(image);
+    }
+
     /**
      * \brief Hook function which is called during initialization
      * \return Initial belief state
@@ -77,6 +89,17 @@ public:
      */
     virtual State track(const Obsrv& image);
 
+    /**
+     * \brief perform a single filter step which returns by the given deadline
+     *        as far as the tracker supports it
+     *
+     * \param image
+     *     Current observation image
+     * \param deadline
+     *     Point in time by which the step should be done
+     */
+    virtual State track(const Obsrv& image, const Deadline& deadline);
+
     /**
      * \brief Initializes the particle filter with the given initial states and
      *     the number of evaluations
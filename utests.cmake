@@ -13,3 +13,71 @@ dbot_add_test(
     NAME    file_shader_provider_test
     SOURCES source/dbot/file_shader_provider_test.cpp
     LIBS	  ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    rigid_body_renderer
+    SOURCES source/dbot/rigid_body_renderer_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    depth_layer_cache
+    SOURCES source/dbot/depth_layer_cache_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    mesh_simplification
+    SOURCES source/dbot/mesh_simplification_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    gaussian_noise_generator
+    SOURCES source/dbot/gaussian_noise_generator_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    checkpoint
+    SOURCES source/dbot/checkpoint_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    resampling
+    SOURCES source/dbot/filter/resampling_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    kld_sampling
+    SOURCES source/dbot/filter/kld_sampling_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    sampling_block_partitioner
+    SOURCES source/dbot/filter/sampling_block_partitioner_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    block_diagonal_linear_transition
+    SOURCES source/dbot/model/block_diagonal_linear_transition_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    occlusion_quantizer
+    SOURCES source/dbot/model/occlusion_quantizer_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    occlusion_process
+    SOURCES source/dbot/model/occlusion_process_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    kinect_pixel_kernel
+    SOURCES source/dbot/model/kinect_pixel_kernel_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+# needs a headless context, with GLX the tests could not run without display
+if(DBOT_BUILD_GL AND NOT DBOT_GL_CONTEXT STREQUAL "GLX")
+    dbot_add_test(
+        NAME    object_rasterizer
+        SOURCES source/dbot/gpu/object_rasterizer_test.cpp
+        LIBS    ${dbot_LIBRARIES})
+endif(DBOT_BUILD_GL AND NOT DBOT_GL_CONTEXT STREQUAL "GLX")